@@ -7,9 +7,15 @@
 #define HAVE_STRING_H 1
 #define HAVE_LIMITS_H 1
 #define HAVE_STDARG_H 1
+#define HAVE_ERRNO_H 1
 #define HAVE_GETOPT_H 1
 #define HAVE_UNISTD_H 1
 
+#ifndef _WIN32
+#define HAVE_PTHREAD_H 1
+#define HAVE_MMAP 1
+#endif
+
 #define HAVE_C99_VARARGS_MACROS 1
 // #define HAVE_SNDFILE 1
 // #define HAVE_SAMPLERATE 1
@@ -19,7 +25,7 @@
 // #define HAVE_AVUTIL 1
 // #define HAVE_AVRESAMPLE 1
 // #define HAVE_LIBAV 1
-// #define HAVE_WAVREAD 1
+#define HAVE_WAVREAD 1
 // #define HAVE_WAVWRITE 1
 #define HAVE_MEMCPY_HACKS 1
 
@@ -207,10 +207,12 @@ extern "C"
 #include "io/source_apple_audio.h"
 #include "io/source_avcodec.h"
 #include "io/source_wavread.h"
+#include "io/source_wavmmap.h"
 #include "io/sink_sndfile.h"
 #include "io/sink_apple_audio.h"
 #include "io/sink_wavwrite.h"
 #include "io/audio_unit.h"
+#include "spectral/frontend.h"
 #include "onset/peakpicker.h"
 #include "pitch/pitchmcomb.h"
 #include "pitch/pitchyin.h"
@@ -219,6 +221,7 @@ extern "C"
 #include "pitch/pitchschmitt.h"
 #include "pitch/pitchfcomb.h"
 #include "pitch/pitchspecacf.h"
+#include "pitch/pitchpyin.h"
 #include "tempo/beattracking.h"
 #include "effects/pitchshift.h"
 #include "effects/timestretch.h"
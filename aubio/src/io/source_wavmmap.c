@@ -0,0 +1,444 @@
+/*
+  Copyright (C) 2022 Filipe Coelho <falktx@falktx.com>
+
+  This file is part of aubio.
+
+  aubio is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  aubio is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with aubio.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "aubio_priv.h"
+
+#ifdef HAVE_MMAP
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "fvec.h"
+#include "fmat.h"
+#include "ioutils.h"
+#include "source_wavmmap.h"
+
+/** number of frames to ask the kernel to read ahead of the read position */
+#define AUBIO_WAVMMAP_READAHEAD 65536
+
+#define WAVE_FORMAT_PCM        0x0001
+#define WAVE_FORMAT_IEEE_FLOAT 0x0003
+#define WAVE_FORMAT_EXTENSIBLE 0xFFFE
+
+struct _aubio_source_wavmmap_t {
+  uint_t hop_size;
+  uint_t samplerate;
+
+  // some data about the file
+  char_t *path;
+  uint_t input_samplerate;
+  uint_t input_channels;
+
+  // internal stuff
+  unsigned char *map;
+  size_t map_size;
+  size_t page_size;
+  const unsigned char *samples;
+
+  uint_t format;
+  uint_t bitspersample;
+  uint_t blockalign;
+
+  uint_t duration;
+  uint_t read_index;
+  uint_t advised_until;
+};
+
+static uint_t read_le16 (const unsigned char *p);
+static uint_t read_le32 (const unsigned char *p);
+static void aubio_source_wavmmap_convert (const aubio_source_wavmmap_t * s,
+    uint_t pos, uint_t count, uint_t channel, smpl_t scale, uint_t add,
+    smpl_t * out);
+static void aubio_source_wavmmap_readahead (aubio_source_wavmmap_t * s,
+    uint_t pos);
+
+uint_t read_le16 (const unsigned char *p)
+{
+  return (uint_t)p[0] | ((uint_t)p[1] << 8);
+}
+
+uint_t read_le32 (const unsigned char *p)
+{
+  return (uint_t)p[0] | ((uint_t)p[1] << 8) | ((uint_t)p[2] << 16)
+    | ((uint_t)p[3] << 24);
+}
+
+aubio_source_wavmmap_t * new_aubio_source_wavmmap(const char_t * path,
+    uint_t samplerate, uint_t hop_size)
+{
+  aubio_source_wavmmap_t * s = AUBIO_NEW(aubio_source_wavmmap_t);
+  const unsigned char *fmt = NULL;
+  size_t pos, data_pos = 0, data_size = 0;
+  struct stat st;
+  int fd;
+
+  if (path == NULL) {
+    AUBIO_ERR("source_wavmmap: Aborted opening null path\n");
+    goto beach;
+  }
+  if ((sint_t)samplerate < 0) {
+    AUBIO_ERR("source_wavmmap: Can not open %s with samplerate %d\n", path, samplerate);
+    goto beach;
+  }
+  if ((sint_t)hop_size <= 0) {
+    AUBIO_ERR("source_wavmmap: Can not open %s with hop_size %d\n", path, hop_size);
+    goto beach;
+  }
+
+  s->path = AUBIO_ARRAY(char_t, strnlen(path, PATH_MAX) + 1);
+  strncpy(s->path, path, strnlen(path, PATH_MAX) + 1);
+
+  s->samplerate = samplerate;
+  s->hop_size = hop_size;
+
+  fd = open((const char *)path, O_RDONLY);
+  if (fd < 0) {
+    AUBIO_STRERR("source_wavmmap: Failed opening %s (%s)\n", s->path, errorstr);
+    goto beach;
+  }
+  if (fstat(fd, &st) != 0 || st.st_size < 12) {
+    AUBIO_ERR("source_wavmmap: Failed opening %s (file too short)\n", s->path);
+    close(fd);
+    goto beach;
+  }
+  s->map_size = (size_t)st.st_size;
+  s->map = (unsigned char *)mmap(NULL, s->map_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  // the mapping stays valid after closing its file descriptor
+  close(fd);
+  if (s->map == MAP_FAILED) {
+    s->map = NULL;
+    AUBIO_STRERR("source_wavmmap: Failed mapping %s (%s)\n", s->path, errorstr);
+    goto beach;
+  }
+  s->page_size = (size_t)sysconf(_SC_PAGESIZE);
+
+  if (memcmp(s->map, "RIFF", 4) != 0 || memcmp(s->map + 8, "WAVE", 4) != 0) {
+    AUBIO_ERR("source_wavmmap: Failed opening %s (could not find RIFF/WAVE header)\n", s->path);
+    goto beach;
+  }
+
+  // walk through the chunks, looking for 'fmt ' and 'data'
+  pos = 12;
+  while (pos + 8 <= s->map_size) {
+    size_t chunk_size = read_le32(s->map + pos + 4);
+    // sizes are compared with what is left of the file before being added to
+    // pos, which could otherwise wrap around on 32-bit targets
+    size_t remaining = s->map_size - pos - 8;
+    if (memcmp(s->map + pos, "fmt ", 4) == 0 && chunk_size >= 16
+        && chunk_size <= remaining) {
+      fmt = s->map + pos + 8;
+    } else if (memcmp(s->map + pos, "data", 4) == 0) {
+      data_pos = pos + 8;
+      // streamed files may not have a correct data size
+      if (chunk_size == 0 || chunk_size == 0xFFFFFFFF
+          || chunk_size > remaining) {
+        chunk_size = remaining;
+      }
+      data_size = chunk_size;
+      break;
+    }
+    // no room for another chunk after this one
+    if (chunk_size >= remaining) break;
+    // chunks are padded to an even size
+    pos += 8 + chunk_size + (chunk_size & 1);
+  }
+
+  if (fmt == NULL) {
+    AUBIO_ERR("source_wavmmap: Failed opening %s (could not find 'fmt ' chunk)\n", s->path);
+    goto beach;
+  }
+  if (data_pos == 0) {
+    AUBIO_ERR("source_wavmmap: Failed opening %s (could not find 'data' chunk)\n", s->path);
+    goto beach;
+  }
+
+  s->format = read_le16(fmt);
+  s->input_channels = read_le16(fmt + 2);
+  s->input_samplerate = read_le32(fmt + 4);
+  s->blockalign = read_le16(fmt + 12);
+  s->bitspersample = read_le16(fmt + 14);
+
+  if (s->format == WAVE_FORMAT_EXTENSIBLE) {
+    // the sub format guid starts with the actual format tag
+    if (read_le32(fmt - 4) < 40) {
+      AUBIO_ERR("source_wavmmap: Failed opening %s (short extensible format)\n", s->path);
+      goto beach;
+    }
+    s->format = read_le16(fmt + 24);
+  }
+
+  if (s->format != WAVE_FORMAT_PCM && s->format != WAVE_FORMAT_IEEE_FLOAT) {
+    AUBIO_ERR("source_wavmmap: Failed opening %s (unsupported format %d)\n",
+        s->path, s->format);
+    goto beach;
+  }
+  if ((s->format == WAVE_FORMAT_PCM && s->bitspersample != 8
+        && s->bitspersample != 16 && s->bitspersample != 24
+        && s->bitspersample != 32)
+      || (s->format == WAVE_FORMAT_IEEE_FLOAT && s->bitspersample != 32
+        && s->bitspersample != 64)) {
+    AUBIO_ERR("source_wavmmap: Failed opening %s (can not read %d bits samples)\n",
+        s->path, s->bitspersample);
+    goto beach;
+  }
+  if ( s->input_channels == 0 ) {
+    AUBIO_ERR("source_wavmmap: Failed opening %s (number of channels can not be 0)\n", s->path);
+    goto beach;
+  }
+  if ( (sint_t)s->input_samplerate <= 0 ) {
+    AUBIO_ERR("source_wavmmap: Failed opening %s (samplerate can not be <= 0)\n", s->path);
+    goto beach;
+  }
+  if ( s->blockalign * 8 != s->input_channels * s->bitspersample ) {
+    AUBIO_ERR("source_wavmmap: Failed opening %s (wrong blockalign)\n", s->path);
+    goto beach;
+  }
+
+  if (samplerate == 0) {
+    s->samplerate = s->input_samplerate;
+  } else if (samplerate != s->input_samplerate) {
+    AUBIO_ERR("source_wavmmap: can not resample %s from %d to %dHz\n",
+        s->path, s->input_samplerate, samplerate);
+    goto beach;
+  }
+
+  s->samples = s->map + data_pos;
+  s->duration = (uint_t)MIN(data_size / s->blockalign, (size_t)UINT_MAX);
+  s->read_index = 0;
+  s->advised_until = 0;
+
+  posix_madvise(s->map, s->map_size, POSIX_MADV_SEQUENTIAL);
+  aubio_source_wavmmap_readahead(s, 0);
+
+  return s;
+
+beach:
+  del_aubio_source_wavmmap(s);
+  return NULL;
+}
+
+/* convert count frames of one channel starting at frame pos, the loops are
+ * kept simple enough for the compiler to vectorize them */
+void aubio_source_wavmmap_convert (const aubio_source_wavmmap_t * s,
+    uint_t pos, uint_t count, uint_t channel, smpl_t scale, uint_t add,
+    smpl_t * out)
+{
+  const uint_t stride = s->blockalign;
+  const uint_t bytes = s->bitspersample / 8;
+  const unsigned char *src = s->samples + (size_t)pos * stride
+    + channel * bytes;
+  uint_t i;
+  if (!add) {
+    AUBIO_MEMSET(out, 0, count * sizeof(smpl_t));
+  }
+  if (s->format == WAVE_FORMAT_IEEE_FLOAT) {
+    if (bytes == 4) {
+      for (i = 0; i < count; i++) {
+        const unsigned char *p = src + (size_t)i * stride;
+        uint32_t u = (uint32_t)p[0] | ((uint32_t)p[1] << 8)
+          | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+        float v;
+        memcpy(&v, &u, sizeof(v));
+        out[i] += v * scale;
+      }
+    } else {
+      for (i = 0; i < count; i++) {
+        const unsigned char *p = src + (size_t)i * stride;
+        uint64_t u = (uint64_t)read_le32(p) | ((uint64_t)read_le32(p + 4) << 32);
+        double v;
+        memcpy(&v, &u, sizeof(v));
+        out[i] += (smpl_t)v * scale;
+      }
+    }
+    return;
+  }
+  switch (bytes) {
+    case 1:
+      scale /= 128.;
+      for (i = 0; i < count; i++) {
+        out[i] += ((sint_t)src[(size_t)i * stride] - 128) * scale;
+      }
+      break;
+    case 2:
+      scale /= 32768.;
+      for (i = 0; i < count; i++) {
+        const unsigned char *p = src + (size_t)i * stride;
+        out[i] += (int16_t)(p[0] | (p[1] << 8)) * scale;
+      }
+      break;
+    case 3:
+      scale /= 8388608.;
+      for (i = 0; i < count; i++) {
+        const unsigned char *p = src + (size_t)i * stride;
+        out[i] += ((int32_t)(((uint32_t)p[0] << 8) | ((uint32_t)p[1] << 16)
+              | ((uint32_t)p[2] << 24)) >> 8) * scale;
+      }
+      break;
+    case 4:
+      scale /= 2147483648.;
+      for (i = 0; i < count; i++) {
+        const unsigned char *p = src + (size_t)i * stride;
+        out[i] += (int32_t)((uint32_t)p[0] | ((uint32_t)p[1] << 8)
+            | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24)) * scale;
+      }
+      break;
+    default:
+      break;
+  }
+}
+
+/* ask the kernel to start reading the pages following pos */
+void aubio_source_wavmmap_readahead (aubio_source_wavmmap_t * s, uint_t pos)
+{
+  size_t start, end;
+  uint_t until;
+  if (pos < s->advised_until && pos + s->hop_size <= s->advised_until) return;
+  until = pos + MAX(AUBIO_WAVMMAP_READAHEAD, 2 * s->hop_size);
+  until = MIN(until, s->duration);
+  start = (size_t)(s->samples - s->map) + (size_t)pos * s->blockalign;
+  end = (size_t)(s->samples - s->map) + (size_t)until * s->blockalign;
+  // the address given to madvise must be page aligned
+  start -= start % s->page_size;
+  if (end > start) {
+    posix_madvise(s->map + start, end - start, POSIX_MADV_WILLNEED);
+  }
+  s->advised_until = until;
+}
+
+void aubio_source_wavmmap_read_at(const aubio_source_wavmmap_t * s, uint_t pos,
+    fvec_t * read_data, uint_t * read)
+{
+  uint_t j, length = 0;
+  if (s->map == NULL) {
+    AUBIO_ERR("source_wavmmap: could not read from %s (file not opened)\n",
+        s->path);
+    *read = 0;
+    return;
+  }
+  if (pos < s->duration) {
+    length = MIN(read_data->length, s->duration - pos);
+  }
+  if (length > 0) {
+    smpl_t scale = 1. / s->input_channels;
+    for (j = 0; j < s->input_channels; j++) {
+      aubio_source_wavmmap_convert(s, pos, length, j, scale, j > 0,
+          read_data->data);
+    }
+  }
+  aubio_source_pad_output (read_data, length);
+  *read = length;
+}
+
+void aubio_source_wavmmap_do(aubio_source_wavmmap_t * s, fvec_t * read_data,
+    uint_t * read)
+{
+  uint_t length = aubio_source_validate_input_length("source_wavmmap", s->path,
+      s->hop_size, read_data->length);
+  fvec_t read_to;
+  read_to.data = read_data->data;
+  read_to.length = length;
+  if (s->map) aubio_source_wavmmap_readahead(s, s->read_index);
+  aubio_source_wavmmap_read_at(s, s->read_index, &read_to, read);
+  aubio_source_pad_output (read_data, *read);
+  s->read_index += *read;
+}
+
+void aubio_source_wavmmap_do_multi(aubio_source_wavmmap_t * s,
+    fmat_t * read_data, uint_t * read)
+{
+  uint_t j, length = aubio_source_validate_input_length("source_wavmmap",
+      s->path, s->hop_size, read_data->length);
+  uint_t channels = aubio_source_validate_input_channels("source_wavmmap",
+      s->path, s->input_channels, read_data->height);
+  if (s->map == NULL) {
+    AUBIO_ERR("source_wavmmap: could not read from %s (file not opened)\n",
+        s->path);
+    *read = 0;
+    return;
+  }
+  aubio_source_wavmmap_readahead(s, s->read_index);
+  if (s->read_index < s->duration) {
+    length = MIN(length, s->duration - s->read_index);
+  } else {
+    length = 0;
+  }
+  for (j = 0; j < channels; j++) {
+    aubio_source_wavmmap_convert(s, s->read_index, length, j, 1., 0,
+        read_data->data[j]);
+  }
+  aubio_source_pad_multi_output(read_data, s->input_channels, length);
+  s->read_index += length;
+  *read = length;
+}
+
+uint_t aubio_source_wavmmap_get_samplerate(const aubio_source_wavmmap_t * s) {
+  return s->samplerate;
+}
+
+uint_t aubio_source_wavmmap_get_channels(const aubio_source_wavmmap_t * s) {
+  return s->input_channels;
+}
+
+uint_t aubio_source_wavmmap_seek (aubio_source_wavmmap_t * s, uint_t pos) {
+  if (s->map == NULL) {
+    AUBIO_ERR("source_wavmmap: could not seek %s (file not opened?)\n", s->path);
+    return AUBIO_FAIL;
+  }
+  if ((sint_t)pos < 0) {
+    AUBIO_ERR("source_wavmmap: could not seek %s at %d (seeking position should be >= 0)\n", s->path, pos);
+    return AUBIO_FAIL;
+  }
+  s->read_index = MIN(pos, s->duration);
+  s->advised_until = 0;
+  aubio_source_wavmmap_readahead(s, s->read_index);
+  return AUBIO_OK;
+}
+
+uint_t aubio_source_wavmmap_get_duration (const aubio_source_wavmmap_t * s) {
+  if (s && s->duration) {
+    return s->duration;
+  }
+  return 0;
+}
+
+uint_t aubio_source_wavmmap_close (aubio_source_wavmmap_t * s) {
+  if (s->map == NULL) {
+    return AUBIO_OK;
+  }
+  if (munmap(s->map, s->map_size) != 0) {
+    AUBIO_STRERR("source_wavmmap: could not close %s (%s)\n", s->path, errorstr);
+    return AUBIO_FAIL;
+  }
+  s->map = NULL;
+  s->samples = NULL;
+  return AUBIO_OK;
+}
+
+void del_aubio_source_wavmmap(aubio_source_wavmmap_t * s) {
+  AUBIO_ASSERT(s);
+  aubio_source_wavmmap_close(s);
+  if (s->path) AUBIO_FREE(s->path);
+  AUBIO_FREE(s);
+}
+
+#endif /* HAVE_MMAP */
@@ -0,0 +1,171 @@
+/*
+  Copyright (C) 2022 Filipe Coelho <falktx@falktx.com>
+
+  This file is part of aubio.
+
+  aubio is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  aubio is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with aubio.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef AUBIO_SOURCE_WAVMMAP_H
+#define AUBIO_SOURCE_WAVMMAP_H
+
+/** \file
+
+  Read from a memory mapped wav file.
+
+  Unlike ::aubio_source_wavread_t, the file is not read through an
+  intermediate buffer: samples are converted straight from the mapping into
+  the output vectors. 8, 16, 24 and 32 bit integer PCM, 32 and 64 bit floating
+  point, and WAVE_FORMAT_EXTENSIBLE files are supported.
+
+  Frames can also be read at any position without changing the read position
+  of the source, see aubio_source_wavmmap_read_at(). Several threads can use
+  this function on the same source at once, to process segments of a file in
+  parallel.
+
+  Only available on systems providing `mmap`.
+
+*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** wavmmap media source object */
+typedef struct _aubio_source_wavmmap_t aubio_source_wavmmap_t;
+
+/**
+
+  create new ::aubio_source_wavmmap_t
+
+  \param uri the file path or uri to read from
+  \param samplerate sampling rate to view the fie at
+  \param hop_size the size of the blocks to read from
+
+  Creates a new source object. If `0` is passed as `samplerate`, the sample
+  rate of the original file is used.
+
+*/
+aubio_source_wavmmap_t * new_aubio_source_wavmmap(const char_t * uri, uint_t samplerate, uint_t hop_size);
+
+/**
+
+  read monophonic vector of length hop_size from source object
+
+  \param s source object, created with ::new_aubio_source_wavmmap
+  \param read_to ::fvec_t of data to read to
+  \param[out] read upon returns, equals to number of frames actually read
+
+  Channels are down-mixed. Upon returns, `read` contains the number of frames
+  actually read from the source. `hop_size` if enough frames could be read,
+  less otherwise.
+
+*/
+void aubio_source_wavmmap_do(aubio_source_wavmmap_t * s, fvec_t * read_to, uint_t * read);
+
+/**
+
+  read polyphonic vector of length hop_size from source object
+
+  \param s source object, created with ::new_aubio_source_wavmmap
+  \param read_to ::fmat_t of data to read to
+  \param read upon returns, equals to number of frames actually read
+
+*/
+void aubio_source_wavmmap_do_multi(aubio_source_wavmmap_t * s, fmat_t * read_to, uint_t * read);
+
+/**
+
+  read monophonic vector at a given position, without seeking
+
+  \param s source object, created with ::new_aubio_source_wavmmap
+  \param pos position to read from, in frames
+  \param read_to ::fvec_t of data to read to, filled up to its length
+  \param[out] read upon returns, equals to number of frames actually read
+
+  This function does not modify the source object and can be called from
+  several threads at once.
+
+*/
+void aubio_source_wavmmap_read_at(const aubio_source_wavmmap_t * s, uint_t pos,
+    fvec_t * read_to, uint_t * read);
+
+/**
+
+  get samplerate of source object
+
+  \param s source object, created with ::new_aubio_source_wavmmap
+  \return samplerate, in Hz
+
+*/
+uint_t aubio_source_wavmmap_get_samplerate(const aubio_source_wavmmap_t * s);
+
+/**
+
+  get number of channels of source object
+
+  \param s source object, created with ::new_aubio_source_wavmmap
+  \return number of channels
+
+*/
+uint_t aubio_source_wavmmap_get_channels (const aubio_source_wavmmap_t * s);
+
+/**
+
+  seek source object
+
+  \param s source object, created with ::new_aubio_source_wavmmap
+  \param pos position to seek to, in frames
+
+  \return 0 if sucessful, non-zero on failure
+
+*/
+uint_t aubio_source_wavmmap_seek (aubio_source_wavmmap_t *s, uint_t pos);
+
+/**
+
+  get the duration of source object, in frames
+
+  \param s source object, created with ::new_aubio_source_wavmmap
+  \return number of frames in file
+
+*/
+uint_t aubio_source_wavmmap_get_duration (const aubio_source_wavmmap_t *s);
+
+/**
+
+  close source
+
+  \param s source object, created with ::new_aubio_source_wavmmap
+
+  \return 0 if sucessful, non-zero on failure
+
+*/
+uint_t aubio_source_wavmmap_close (aubio_source_wavmmap_t *s);
+
+/**
+
+  close source and cleanup memory
+
+  \param s source object, created with ::new_aubio_source_wavmmap
+
+*/
+void del_aubio_source_wavmmap(aubio_source_wavmmap_t * s);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AUBIO_SOURCE_WAVMMAP_H */
@@ -483,6 +483,141 @@ smpl_t fvec_median (fvec_t * input) {
   }
 }
 
+/* sliding median, using two heaps sharing one array centered on the median:
+ * heap[0] is the median, heap[-1..-maxct] a max-heap of the smaller values and
+ * heap[1..minct] a min-heap of the larger values. the children of i are at 2i
+ * and 2i+1 (2i and 2i-1 for negative positions). */
+struct _aubio_median_t {
+  smpl_t *data;   /**< window of values, used as a ring buffer */
+  sint_t *pos;    /**< heap position of each value of the window */
+  sint_t *alloc;  /**< heap storage */
+  sint_t *heap;   /**< heap centered on the median, indices into data */
+  uint_t length;  /**< window length */
+  uint_t idx;     /**< position of the oldest value in the window */
+};
+
+#define aubio_median_minct(m) ((sint_t)((m)->length / 2))
+#define aubio_median_maxct(m) ((sint_t)(((m)->length - 1) / 2))
+
+static uint_t aubio_median_less (aubio_median_t * m, sint_t i, sint_t j) {
+  return m->data[m->heap[i]] < m->data[m->heap[j]];
+}
+
+/* swap heap positions i and j if the value at i is less than the one at j */
+static uint_t aubio_median_cmp_exchange (aubio_median_t * m, sint_t i, sint_t j) {
+  sint_t tmp;
+  if (!aubio_median_less (m, i, j)) return 0;
+  tmp = m->heap[i];
+  m->heap[i] = m->heap[j];
+  m->heap[j] = tmp;
+  m->pos[m->heap[i]] = i;
+  m->pos[m->heap[j]] = j;
+  return 1;
+}
+
+/* restore the min-heap below i, starting from its child position i */
+static void aubio_median_min_sort_down (aubio_median_t * m, sint_t i) {
+  for (; i <= aubio_median_minct (m); i *= 2) {
+    if (i > 1 && i < aubio_median_minct (m) && aubio_median_less (m, i + 1, i))
+      ++i;
+    if (!aubio_median_cmp_exchange (m, i, i / 2)) break;
+  }
+}
+
+/* restore the max-heap below i, starting from its child position i */
+static void aubio_median_max_sort_down (aubio_median_t * m, sint_t i) {
+  for (; i >= -aubio_median_maxct (m); i *= 2) {
+    if (i < -1 && i > -aubio_median_maxct (m) && aubio_median_less (m, i, i - 1))
+      --i;
+    if (!aubio_median_cmp_exchange (m, i / 2, i)) break;
+  }
+}
+
+/* move i up the min-heap, returns 1 if it reached the median position */
+static uint_t aubio_median_min_sort_up (aubio_median_t * m, sint_t i) {
+  while (i > 0 && aubio_median_cmp_exchange (m, i, i / 2)) i /= 2;
+  return i == 0;
+}
+
+/* move i up the max-heap, returns 1 if it reached the median position */
+static uint_t aubio_median_max_sort_up (aubio_median_t * m, sint_t i) {
+  while (i < 0 && aubio_median_cmp_exchange (m, i / 2, i)) i /= 2;
+  return i == 0;
+}
+
+aubio_median_t * new_aubio_median (uint_t length) {
+  aubio_median_t * m;
+  if ((sint_t)length < 1) {
+    AUBIO_ERR("median: got length %d, but can not be < 1\n", length);
+    return NULL;
+  }
+  m = AUBIO_NEW (aubio_median_t);
+  m->length = length;
+  m->data = AUBIO_ARRAY (smpl_t, length);
+  m->pos = AUBIO_ARRAY (sint_t, length);
+  m->alloc = AUBIO_ARRAY (sint_t, length);
+  m->heap = m->alloc + aubio_median_maxct (m);
+  aubio_median_reset (m);
+  return m;
+}
+
+void aubio_median_reset (aubio_median_t * m) {
+  uint_t i;
+  /* alternate values between both heaps, all zeros are in heap order */
+  for (i = 0; i < m->length; i++) {
+    m->data[i] = 0.;
+    m->pos[i] = ((i + 1) / 2) * ((i & 1) ? 1 : -1);
+    m->heap[m->pos[i]] = i;
+  }
+  m->idx = 0;
+}
+
+/* replace the value at index i of the window and restore both heaps */
+static void aubio_median_update (aubio_median_t * m, uint_t i, smpl_t input) {
+  sint_t p = m->pos[i];
+  smpl_t old = m->data[i];
+  m->data[i] = input;
+  if (p > 0) {
+    /* replaced value is in the min-heap */
+    if (old < input) aubio_median_min_sort_down (m, p * 2);
+    else if (aubio_median_min_sort_up (m, p)) aubio_median_max_sort_down (m, -1);
+  } else if (p < 0) {
+    /* replaced value is in the max-heap */
+    if (input < old) aubio_median_max_sort_down (m, p * 2);
+    else if (aubio_median_max_sort_up (m, p)) aubio_median_min_sort_down (m, 1);
+  } else {
+    /* replaced value is the median */
+    if (aubio_median_maxct (m)) aubio_median_max_sort_down (m, -1);
+    if (aubio_median_minct (m)) aubio_median_min_sort_down (m, 1);
+  }
+}
+
+smpl_t aubio_median_do (aubio_median_t * m, smpl_t input) {
+  aubio_median_update (m, m->idx, input);
+  m->idx = (m->idx + 1) % m->length;
+  return m->data[m->heap[0]];
+}
+
+smpl_t aubio_median_set (aubio_median_t * m, uint_t age, smpl_t input) {
+  if (age >= m->length) {
+    AUBIO_ERR("median: got age %d, but should be < %d\n", age, m->length);
+    return m->data[m->heap[0]];
+  }
+  aubio_median_update (m, (m->idx + m->length - 1 - age) % m->length, input);
+  return m->data[m->heap[0]];
+}
+
+smpl_t aubio_median_get (const aubio_median_t * m) {
+  return m->data[m->heap[0]];
+}
+
+void del_aubio_median (aubio_median_t * m) {
+  AUBIO_FREE (m->data);
+  AUBIO_FREE (m->pos);
+  AUBIO_FREE (m->alloc);
+  AUBIO_FREE (m);
+}
+
 smpl_t fvec_quadratic_peak_pos (const fvec_t * x, uint_t pos) {
   smpl_t s0, s1, s2; uint_t x0, x2;
   smpl_t half = .5, two = 2.;
@@ -516,6 +651,31 @@ uint_t fvec_peakpick(const fvec_t * onset, uint_t pos) {
   return tmp;
 }
 
+uint_t
+fvec_min_peaks (const fvec_t * v, uint_t end, fvec_t * pos, fvec_t * val)
+{
+  uint_t k = MIN(pos->length, val->length), count = 0, p, j;
+  if (k == 0) return 0;
+  end = MIN(end, v->length);
+  for (p = 1; p + 1 < end; p++) {
+    if (!(v->data[p] < v->data[p - 1] && v->data[p] <= v->data[p + 1]))
+      continue;
+    // insertion in the sorted list of deepest minima, pos holds indices for now
+    if (count < k) count++;
+    else if (v->data[p] >= val->data[k - 1]) continue;
+    for (j = count - 1; j > 0 && val->data[j - 1] > v->data[p]; j--) {
+      pos->data[j] = pos->data[j - 1];
+      val->data[j] = val->data[j - 1];
+    }
+    pos->data[j] = p;
+    val->data[j] = v->data[p];
+  }
+  for (j = 0; j < count; j++) {
+    pos->data[j] = fvec_quadratic_peak_pos (v, (uint_t)pos->data[j]);
+  }
+  return count;
+}
+
 smpl_t
 aubio_quadfrac (smpl_t s0, smpl_t s1, smpl_t s2, smpl_t pf)
 {
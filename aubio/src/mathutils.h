@@ -256,6 +256,79 @@ and in the Public Domain.
 */
 smpl_t fvec_median (fvec_t * v);
 
+/** sliding median object */
+typedef struct _aubio_median_t aubio_median_t;
+
+/** create a sliding median object
+
+  The median is taken over the last `length` values pushed with
+aubio_median_do(). The window initially contains `length` zeros, so that
+results match fvec_median() on a zeroed vector shifted by one element at each
+step.
+
+  Each update costs O(log(length)), using a max-heap of the values below the
+median and a min-heap of the values above it, both indexed from the position
+of each value in the window.
+
+  \param length number of values to take the median of
+
+  \return newly created ::aubio_median_t, or NULL if `length` is 0
+
+*/
+aubio_median_t * new_aubio_median (uint_t length);
+
+/** push a new value and return the median of the current window
+
+  The oldest value of the window is replaced with `input`. For windows of even
+length, the lower of the two middle values is returned, like fvec_median().
+
+  \param m sliding median object, as returned by new_aubio_median()
+  \param input new value
+
+  \return median of the last `length` values
+
+*/
+smpl_t aubio_median_do (aubio_median_t * m, smpl_t input);
+
+/** replace a value of the window and return the new median
+
+  The window keeps its order, `input` takes the place of the value pushed
+`age` steps before the last one. This allows thresholding a vector in place
+while its median is slid over it.
+
+  \param m sliding median object, as returned by new_aubio_median()
+  \param age position of the value to replace, 0 for the last value pushed
+  and up to `length - 1` for the oldest
+  \param input new value
+
+  \return median of the window after the change
+
+*/
+smpl_t aubio_median_set (aubio_median_t * m, uint_t age, smpl_t input);
+
+/** get the median of the current window
+
+  \param m sliding median object, as returned by new_aubio_median()
+
+  \return median of the last `length` values
+
+*/
+smpl_t aubio_median_get (const aubio_median_t * m);
+
+/** fill the window of a sliding median object with zeros
+
+  \param m sliding median object, as returned by new_aubio_median()
+
+*/
+void aubio_median_reset (aubio_median_t * m);
+
+/** delete a sliding median object
+
+  \param m sliding median object, as returned by new_aubio_median()
+
+*/
+void del_aubio_median (aubio_median_t * m);
+
 /** finds exact peak index by quadratic interpolation
 
   See [Quadratic Interpolation of Spectral
@@ -314,6 +387,23 @@ peak is defined as follows:
 */
 uint_t fvec_peakpick (const fvec_t * v, uint_t p);
 
+/** find the deepest local minima of a vector
+
+  A local minimum is found at index p when v[p-1] > v[p] and v[p] <= v[p+1].
+  Minima are searched for in the first `end` elements of `v`, excluding both
+  ends, and the `pos->length` deepest ones are kept.
+
+  \param v input vector
+  \param end number of elements of `v` to search
+  \param pos output interpolated positions of the minima, as computed by
+  fvec_quadratic_peak_pos(), sorted by increasing value
+  \param val output values of `v` at these minima, same length as `pos`
+
+  \return number of minima found, up to `pos->length`
+
+*/
+uint_t fvec_min_peaks (const fvec_t * v, uint_t end, fvec_t * pos, fvec_t * val);
+
 /** return 1 if a is a power of 2, 0 otherwise */
 uint_t aubio_is_power_of_two(uint_t a);
 
@@ -20,6 +20,8 @@
 
 #include "aubio_priv.h"
 #include "fvec.h"
+#include "cvec.h"
+#include "mathutils.h"
 #include "pitch/pitch.h"
 #include "onset/onset.h"
 #include "notes/notes.h"
@@ -40,8 +42,7 @@ struct _aubio_notes_t {
   uint_t samplerate;
 
   uint_t median;
-  fvec_t *note_buffer;
-  fvec_t *note_buffer2;
+  aubio_median_t *note_median;
 
   aubio_pitch_t *pitch;
   fvec_t *pitch_output;
@@ -60,6 +61,9 @@ struct _aubio_notes_t {
 
   smpl_t last_onset_level;
   smpl_t release_drop_level;
+
+  smpl_t early_confidence;
+  uint_t early_sent;
 };
 
 aubio_notes_t * new_aubio_notes (const char_t * method,
@@ -97,11 +101,9 @@ aubio_notes_t * new_aubio_notes (const char_t * method,
     AUBIO_ERR("notes: unknown notes detection method \"%s\"\n", method);
     goto fail;
   }
-  o->note_buffer = new_fvec(o->median);
-  o->note_buffer2 = new_fvec(o->median);
+  o->note_median = new_aubio_median(o->median);
 
-  if (!o->onset_output || !o->pitch_output ||
-      !o->note_buffer || !o->note_buffer2) goto fail;
+  if (!o->onset_output || !o->pitch_output || !o->note_median) goto fail;
 
   o->curnote = -1.;
   o->newnote = 0.;
@@ -112,6 +114,9 @@ aubio_notes_t * new_aubio_notes (const char_t * method,
   o->last_onset_level = AUBIO_DEFAULT_NOTES_SILENCE;
   o->release_drop_level = AUBIO_DEFAULT_NOTES_RELEASE_DROP;
 
+  o->early_confidence = 0.;
+  o->early_sent = 0;
+
   return o;
 
 fail:
@@ -168,25 +173,35 @@ smpl_t aubio_notes_get_release_drop(const aubio_notes_t *o)
   return o->release_drop_level;
 }
 
-/** append new note candidate to the note_buffer and return filtered value. we
- * need to copy the input array as fvec_median destroy its input data.*/
-static void
-note_append (fvec_t * note_buffer, smpl_t curnote)
+uint_t aubio_notes_set_early_confidence(aubio_notes_t *o, smpl_t confidence)
 {
-  uint_t i = 0;
-  for (i = 0; i < note_buffer->length - 1; i++) {
-    note_buffer->data[i] = note_buffer->data[i + 1];
+  uint_t err = AUBIO_OK;
+  if (confidence < 0. || confidence > 1.) {
+    AUBIO_ERR("notes: early_confidence should be in [0, 1], got %f\n", confidence);
+    err = AUBIO_FAIL;
+  } else {
+    o->early_confidence = confidence;
   }
-  //note_buffer->data[note_buffer->length - 1] = ROUND(10.*curnote)/10.;
-  note_buffer->data[note_buffer->length - 1] = ROUND(AUBIO_DEFAULT_CENT_PRECISION*curnote);
-  return;
+  return err;
+}
+
+smpl_t aubio_notes_get_early_confidence(const aubio_notes_t *o)
+{
+  return o->early_confidence;
+}
+
+/** append new note candidate to the sliding median of note candidates */
+static void
+note_append (aubio_median_t * note_median, smpl_t curnote)
+{
+  //aubio_median_do(note_median, ROUND(10.*curnote)/10.);
+  aubio_median_do(note_median, ROUND(AUBIO_DEFAULT_CENT_PRECISION*curnote));
 }
 
 static smpl_t
 aubio_notes_get_latest_note (aubio_notes_t *o)
 {
-  fvec_copy(o->note_buffer, o->note_buffer2);
-  return fvec_median (o->note_buffer2) / AUBIO_DEFAULT_CENT_PRECISION;
+  return aubio_median_get (o->note_median) / AUBIO_DEFAULT_CENT_PRECISION;
 }
 
 
@@ -199,7 +214,7 @@ void aubio_notes_do (aubio_notes_t *o, const fvec_t * input, fvec_t * notes)
   aubio_pitch_do (o->pitch, input, o->pitch_output);
   new_pitch = o->pitch_output->data[0];
   if(o->median){
-    note_append(o->note_buffer, new_pitch);
+    note_append(o->note_median, new_pitch);
   }
 
   /* curlevel is negatif or 1 if silence */
@@ -217,6 +232,7 @@ void aubio_notes_do (aubio_notes_t *o, const fvec_t * input, fvec_t * notes)
     } else {
       if (o->median) {
         o->isready = 1;
+        o->early_sent = 0;
       } else {
         /* kill old note */
         //send_noteon(o->curnote,0, o->samplerate);
@@ -246,8 +262,30 @@ void aubio_notes_do (aubio_notes_t *o, const fvec_t * input, fvec_t * notes)
     {
       if (o->isready > 0)
         o->isready++;
-      if (o->isready == o->median)
+      if (o->isready > 1 && o->isready < o->median && !o->early_sent
+          && o->early_confidence > 0.
+          && aubio_pitch_get_confidence(o->pitch) >= o->early_confidence)
       {
+        /* confident estimate before the median is full, send it right away */
+        o->newnote = ROUND(AUBIO_DEFAULT_CENT_PRECISION * new_pitch)
+          / AUBIO_DEFAULT_CENT_PRECISION;
+        if (o->newnote > 45) {
+          if (o->curnote != 0) notes->data[2] = o->curnote;
+          o->curnote = o->newnote;
+          notes->data[0] = o->curnote;
+          notes->data[1] = 127 + (int) floor(curlevel);
+          o->early_sent = 1;
+        }
+      }
+      else if (o->isready == o->median)
+      {
+        o->newnote = aubio_notes_get_latest_note(o);
+        /* keep the early note if the median agrees with it */
+        if (o->early_sent && o->newnote == o->curnote) {
+          o->early_sent = 0;
+          return;
+        }
+        o->early_sent = 0;
         /* kill old note */
         //send_noteon(curnote,0);
         if (o->curnote != 0)
@@ -255,7 +293,6 @@ void aubio_notes_do (aubio_notes_t *o, const fvec_t * input, fvec_t * notes)
           //AUBIO_WRN("notes: sending note-off, new note detected\n");
           notes->data[2] = o->curnote;
         }
-        o->newnote = aubio_notes_get_latest_note(o);
         o->curnote = o->newnote;
         /* get and send new one */
         if (o->curnote>45){
@@ -269,8 +306,7 @@ void aubio_notes_do (aubio_notes_t *o, const fvec_t * input, fvec_t * notes)
 }
 
 void del_aubio_notes (aubio_notes_t *o) {
-  if (o->note_buffer) del_fvec(o->note_buffer);
-  if (o->note_buffer2) del_fvec(o->note_buffer2);
+  if (o->note_median) del_aubio_median(o->note_median);
   if (o->pitch_output) del_fvec(o->pitch_output);
   if (o->pitch) del_aubio_pitch(o->pitch);
   if (o->onset_output) del_fvec(o->onset_output);
@@ -136,6 +136,33 @@ smpl_t aubio_notes_get_release_drop (const aubio_notes_t *o);
 */
 uint_t aubio_notes_set_release_drop (aubio_notes_t *o, smpl_t release_drop);
 
+/** get notes object early note-on confidence
+
+  \param o notes detection object as returned by new_aubio_notes()
+
+  \return current early note-on confidence, or `0` if disabled
+
+ */
+smpl_t aubio_notes_get_early_confidence (const aubio_notes_t *o);
+
+/** set notes object early note-on confidence
+
+  After an onset, a note-on is normally emitted once the median of the next
+  few pitch estimates is known. When this parameter is set, a note-on is sent
+  as soon as the pitch confidence reaches `confidence`, before the median is
+  complete. If the median later disagrees, the early note is replaced.
+
+  Defaults to `0`, disabled.
+
+  \param o notes detection object as returned by new_aubio_notes()
+  \param confidence pitch confidence required for an early note-on, in
+  `[0, 1]`, or `0` to disable
+
+  \return 0 on success, non-zero otherwise
+
+*/
+uint_t aubio_notes_set_early_confidence (aubio_notes_t *o, smpl_t confidence);
+
 #ifdef __cplusplus
 }
 #endif
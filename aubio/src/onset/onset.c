@@ -52,11 +52,42 @@ struct _aubio_onset_t {
   aubio_spectral_whitening_t *spectral_whitening;
 };
 
+/* apply whitening and compression to o->fftgrain, in place */
+static void aubio_onset_preprocess (aubio_onset_t *o);
+
+/* run spectral description and peak picking on a spectral frame */
+static void aubio_onset_detect (aubio_onset_t *o, const fvec_t * input,
+    const cvec_t * fftgrain, fvec_t * onset);
+
 /* execute onset detection function on iput buffer */
 void aubio_onset_do (aubio_onset_t *o, const fvec_t * input, fvec_t * onset)
 {
-  smpl_t isonset = 0;
   aubio_pvoc_do (o->pv,input, o->fftgrain);
+  aubio_onset_preprocess (o);
+  aubio_onset_detect (o, input, o->fftgrain, onset);
+}
+
+uint_t aubio_onset_do_spectrum (aubio_onset_t *o, const fvec_t * input,
+    const cvec_t * spectrum, fvec_t * onset)
+{
+  if (spectrum->length != o->fftgrain->length) {
+    AUBIO_ERR ("onset: spectrum has %d bins, expected %d\n",
+        spectrum->length, o->fftgrain->length);
+    return AUBIO_FAIL;
+  }
+  if (o->apply_awhitening || o->apply_compression) {
+    // these modify the spectrum, work on a copy
+    cvec_copy (spectrum, o->fftgrain);
+    aubio_onset_preprocess (o);
+    aubio_onset_detect (o, input, o->fftgrain, onset);
+  } else {
+    aubio_onset_detect (o, input, spectrum, onset);
+  }
+  return AUBIO_OK;
+}
+
+static void aubio_onset_preprocess (aubio_onset_t *o)
+{
   /*
   if (apply_filtering) {
   }
@@ -67,7 +98,13 @@ void aubio_onset_do (aubio_onset_t *o, const fvec_t * input, fvec_t * onset)
   if (o->apply_compression) {
     cvec_logmag(o->fftgrain, o->lambda_compression);
   }
-  aubio_specdesc_do (o->od, o->fftgrain, o->desc);
+}
+
+static void aubio_onset_detect (aubio_onset_t *o, const fvec_t * input,
+    const cvec_t * fftgrain, fvec_t * onset)
+{
+  smpl_t isonset = 0;
+  aubio_specdesc_do (o->od, fftgrain, o->desc);
   aubio_peakpicker_do(o->pp, o->desc, onset);
   isonset = onset->data[0];
   if (isonset > 0.) {
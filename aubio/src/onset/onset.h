@@ -90,6 +90,25 @@ aubio_onset_t * new_aubio_onset (const char_t * method,
 */
 void aubio_onset_do (aubio_onset_t *o, const fvec_t * input, fvec_t * onset);
 
+/** execute onset detection on an input signal frame and its spectrum
+
+  \param o onset detection object as returned by new_aubio_onset()
+  \param input new audio vector of length hop_size
+  \param spectrum spectral frame of the last [buf_size] samples, as computed
+  by aubio_pvoc_do() or a shared ::aubio_frontend_t with the same buffer and
+  hop sizes
+  \param onset output vector of length 1, containing 0 if no onset was found,
+  and a value equal or greater than 1 otherwise
+
+  Same as aubio_onset_do(), without computing the FFT of `input`. The spectrum
+  is not modified, it is copied first if whitening or compression are enabled.
+
+  \return 0 if successful, non-zero if the spectrum size does not match
+
+*/
+uint_t aubio_onset_do_spectrum (aubio_onset_t *o, const fvec_t * input,
+    const cvec_t * spectrum, fvec_t * onset);
+
 /** get the time of the latest onset detected, in samples
 
   \param o onset detection object as returned by new_aubio_onset()
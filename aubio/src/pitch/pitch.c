@@ -24,6 +24,7 @@
 #include "lvec.h"
 #include "mathutils.h"
 #include "musicutils.h"
+#include "spectral/fft.h"
 #include "spectral/phasevoc.h"
 #include "temporal/filter.h"
 #include "temporal/c_weighting.h"
@@ -34,10 +35,21 @@
 #include "pitch/pitchyinfft.h"
 #include "pitch/pitchyinfast.h"
 #include "pitch/pitchspecacf.h"
+#include "pitch/pitchpyin.h"
 #include "pitch/pitch.h"
 
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
 #define DEFAULT_PITCH_SILENCE -50.
 
+/** maximum number of threads used by aubio_pitch_do_multi */
+#define AUBIO_PITCH_MAX_THREADS 64
+
 /** pitch detection algorithms */
 typedef enum
 {
@@ -48,10 +60,18 @@ typedef enum
   aubio_pitcht_yinfft,     /**< `yinfft`, Spectral YIN */
   aubio_pitcht_yinfast,    /**< `yinfast`, YIN fast */
   aubio_pitcht_specacf,    /**< `specacf`, Spectral autocorrelation */
+  aubio_pitcht_dual,       /**< `dual`, YIN fast confirmed by Spectral YIN */
+  aubio_pitcht_pyin,       /**< `pyin`, probabilistic YIN */
   aubio_pitcht_default
     = aubio_pitcht_yinfft, /**< `default` */
 } aubio_pitch_type;
 
+/** method names, in the same order as ::aubio_pitch_type */
+static const char_t *aubio_pitch_methods[] = {
+  "yin", "mcomb", "schmitt", "fcomb", "yinfft", "yinfast", "specacf", "dual",
+  "pyin"
+};
+
 /** pitch detection output modes */
 typedef enum
 {
@@ -78,6 +98,7 @@ struct _aubio_pitch_t
   aubio_pitch_mode mode;          /**< pitch detection output mode */
   uint_t samplerate;              /**< samplerate */
   uint_t bufsize;                 /**< buffer size */
+  uint_t hopsize;                 /**< hop size */
   void *p_object;                 /**< pointer to pitch object */
   aubio_filter_t *filter;         /**< filter */
   fvec_t *filtered;               /**< filtered input */
@@ -88,8 +109,28 @@ struct _aubio_pitch_t
   aubio_pitch_convert_t conv_cb;  /**< callback to convert it to the desired unit */
   aubio_pitch_get_conf_t conf_cb; /**< pointer to the current confidence callback */
   smpl_t silence;                 /**< silence threshold */
+  uint_t silent;                  /**< last frame was below the silence threshold */
+  smpl_t last_freq;               /**< last estimate, in Hz */
+  uint_t nthreads;                /**< number of threads for do_multi, 0 for auto */
+  uint_t nworkers;                /**< number of allocated workers */
+  aubio_pitch_t **workers;        /**< detector copies used by do_multi */
 };
 
+/** yinfast and yinfft sharing one transform of the input, for `dual` */
+typedef struct
+{
+  aubio_pitchyinfast_t *yinfast;  /**< first dip estimate */
+  aubio_pitchyinfft_t *yinfft;    /**< weighted estimate used to confirm it */
+  aubio_fft_t *fft;               /**< forward transform shared by both */
+  fvec_t *compspec;               /**< complex spectrum of the input */
+  fvec_t *cands;                  /**< yinfft candidate */
+  smpl_t confidence;              /**< confidence of the merged estimate */
+} aubio_pitchdual_t;
+
+static aubio_pitchdual_t *new_aubio_pitchdual (uint_t samplerate, uint_t bufsize);
+static void del_aubio_pitchdual (aubio_pitchdual_t * d);
+static smpl_t aubio_pitchdual_get_confidence (aubio_pitchdual_t * d);
+
 /* callback functions for pitch detection */
 static void aubio_pitch_do_mcomb (aubio_pitch_t * p, const fvec_t * ibuf, fvec_t * obuf);
 static void aubio_pitch_do_yin (aubio_pitch_t * p, const fvec_t * ibuf, fvec_t * obuf);
@@ -98,6 +139,8 @@ static void aubio_pitch_do_fcomb (aubio_pitch_t * p, const fvec_t * ibuf, fvec_t
 static void aubio_pitch_do_yinfft (aubio_pitch_t * p, const fvec_t * ibuf, fvec_t * obuf);
 static void aubio_pitch_do_yinfast (aubio_pitch_t * p, const fvec_t * ibuf, fvec_t * obuf);
 static void aubio_pitch_do_specacf (aubio_pitch_t * p, const fvec_t * ibuf, fvec_t * obuf);
+static void aubio_pitch_do_dual (aubio_pitch_t * p, const fvec_t * ibuf, fvec_t * obuf);
+static void aubio_pitch_do_pyin (aubio_pitch_t * p, const fvec_t * ibuf, fvec_t * obuf);
 
 /* internal functions for frequency conversion */
 static smpl_t freqconvbin (smpl_t f, uint_t samplerate, uint_t bufsize);
@@ -107,6 +150,12 @@ static smpl_t freqconvpass (smpl_t f, uint_t samplerate, uint_t bufsize);
 /* adapter to stack ibuf new samples at the end of buf, and trim `buf` to `bufsize` */
 void aubio_pitch_slideblock (aubio_pitch_t * p, const fvec_t * ibuf);
 
+/* internal functions for batched processing */
+static uint_t aubio_pitch_get_threads (aubio_pitch_t * p, uint_t nframes,
+    uint_t hop_size);
+static void aubio_pitch_del_workers (aubio_pitch_t * p);
+static void aubio_pitch_reset (aubio_pitch_t * p);
+
 
 aubio_pitch_t *
 new_aubio_pitch (const char_t * pitch_mode,
@@ -132,6 +181,10 @@ new_aubio_pitch (const char_t * pitch_mode,
     pitch_type = aubio_pitcht_fcomb;
   else if (strcmp (pitch_mode, "specacf") == 0)
     pitch_type = aubio_pitcht_specacf;
+  else if (strcmp (pitch_mode, "dual") == 0)
+    pitch_type = aubio_pitcht_dual;
+  else if (strcmp (pitch_mode, "pyin") == 0)
+    pitch_type = aubio_pitcht_pyin;
   else if (strcmp (pitch_mode, "default") == 0)
     pitch_type = aubio_pitcht_default;
   else {
@@ -158,6 +211,7 @@ new_aubio_pitch (const char_t * pitch_mode,
   p->type = pitch_type;
   aubio_pitch_set_unit (p, "default");
   p->bufsize = bufsize;
+  p->hopsize = hopsize;
   p->silence = DEFAULT_PITCH_SILENCE;
   p->conf_cb = NULL;
   switch (p->type) {
@@ -213,6 +267,20 @@ new_aubio_pitch (const char_t * pitch_mode,
       p->conf_cb = (aubio_pitch_get_conf_t)aubio_pitchspecacf_get_tolerance;
       aubio_pitchspecacf_set_tolerance (p->p_object, 0.85);
       break;
+    case aubio_pitcht_dual:
+      p->buf = new_fvec (bufsize);
+      p->p_object = new_aubio_pitchdual (samplerate, bufsize);
+      if (!p->p_object) goto beach;
+      p->detect_cb = aubio_pitch_do_dual;
+      p->conf_cb = (aubio_pitch_get_conf_t)aubio_pitchdual_get_confidence;
+      break;
+    case aubio_pitcht_pyin:
+      p->buf = new_fvec (bufsize);
+      p->p_object = new_aubio_pitchpyin (samplerate, bufsize);
+      if (!p->p_object) goto beach;
+      p->detect_cb = aubio_pitch_do_pyin;
+      p->conf_cb = (aubio_pitch_get_conf_t)aubio_pitchpyin_get_confidence;
+      break;
     default:
       break;
   }
@@ -228,6 +296,7 @@ beach:
 void
 del_aubio_pitch (aubio_pitch_t * p)
 {
+  aubio_pitch_del_workers (p);
   switch (p->type) {
     case aubio_pitcht_yin:
       del_fvec (p->buf);
@@ -260,6 +329,14 @@ del_aubio_pitch (aubio_pitch_t * p)
       del_fvec (p->buf);
       del_aubio_pitchspecacf (p->p_object);
       break;
+    case aubio_pitcht_dual:
+      del_fvec (p->buf);
+      del_aubio_pitchdual (p->p_object);
+      break;
+    case aubio_pitcht_pyin:
+      del_fvec (p->buf);
+      del_aubio_pitchpyin (p->p_object);
+      break;
     default:
       break;
   }
@@ -349,6 +426,11 @@ aubio_pitch_set_tolerance (aubio_pitch_t * p, smpl_t tol)
     case aubio_pitcht_yinfast:
       aubio_pitchyinfast_set_tolerance (p->p_object, tol);
       break;
+    case aubio_pitcht_dual:
+      aubio_pitchyinfast_set_tolerance (((aubio_pitchdual_t *)p->p_object)->yinfast, tol);
+      break;
+    case aubio_pitcht_pyin:
+      return aubio_pitchpyin_set_tolerance (p->p_object, tol);
     default:
       break;
   }
@@ -369,12 +451,35 @@ aubio_pitch_get_tolerance (aubio_pitch_t * p)
     case aubio_pitcht_yinfast:
       tolerance = aubio_pitchyinfast_get_tolerance (p->p_object);
       break;
+    case aubio_pitcht_dual:
+      tolerance = aubio_pitchyinfast_get_tolerance (((aubio_pitchdual_t *)p->p_object)->yinfast);
+      break;
+    case aubio_pitcht_pyin:
+      tolerance = aubio_pitchpyin_get_tolerance (p->p_object);
+      break;
     default:
       break;
   }
   return tolerance;
 }
 
+uint_t
+aubio_pitch_set_lag (aubio_pitch_t * p, uint_t lag)
+{
+  if (p->type != aubio_pitcht_pyin) {
+    AUBIO_WRN("pitch: only pyin decisions can be delayed\n");
+    return AUBIO_FAIL;
+  }
+  return aubio_pitchpyin_set_lag (p->p_object, lag);
+}
+
+uint_t
+aubio_pitch_get_lag (aubio_pitch_t * p)
+{
+  if (p->type != aubio_pitcht_pyin) return 0;
+  return aubio_pitchpyin_get_lag (p->p_object);
+}
+
 uint_t
 aubio_pitch_set_silence (aubio_pitch_t * p, smpl_t silence)
 {
@@ -399,12 +504,240 @@ void
 aubio_pitch_do (aubio_pitch_t * p, const fvec_t * ibuf, fvec_t * obuf)
 {
   p->detect_cb (p, ibuf, obuf);
-  if (aubio_silence_detection(ibuf, p->silence) == 1) {
+  p->silent = aubio_silence_detection(ibuf, p->silence);
+  // pyin outputs an older frame, silent frames were decoded as unvoiced
+  if (p->silent == 1 && p->type != aubio_pitcht_pyin) {
     obuf->data[0] = 0.;
   }
+  p->last_freq = obuf->data[0];
   obuf->data[0] = p->conv_cb (obuf->data[0], p->samplerate, p->bufsize);
 }
 
+uint_t
+aubio_pitch_do_spectrum (aubio_pitch_t * p, const fvec_t * ibuf,
+    const cvec_t * spectrum, fvec_t * obuf)
+{
+  smpl_t period;
+  if (spectrum->length != p->bufsize / 2 + 1) {
+    AUBIO_ERR ("pitch: spectrum has %d bins, expected %d\n",
+        spectrum->length, p->bufsize / 2 + 1);
+    return AUBIO_FAIL;
+  }
+  switch (p->type) {
+    case aubio_pitcht_yinfft:
+      aubio_pitchyinfft_do_spectrum (p->p_object, spectrum, obuf);
+      period = obuf->data[0];
+      obuf->data[0] = period > 0 ? p->samplerate / period : 0.;
+      break;
+    case aubio_pitcht_mcomb:
+      aubio_filter_do_outplace (p->filter, ibuf, p->filtered);
+      aubio_pitchmcomb_do (p->p_object, spectrum, obuf);
+      obuf->data[0] = aubio_bintofreq (obuf->data[0], p->samplerate, p->bufsize);
+      break;
+    default:
+      p->detect_cb (p, ibuf, obuf);
+      break;
+  }
+  p->silent = aubio_silence_detection(ibuf, p->silence);
+  // pyin outputs an older frame, silent frames were decoded as unvoiced
+  if (p->silent == 1 && p->type != aubio_pitcht_pyin) {
+    obuf->data[0] = 0.;
+  }
+  p->last_freq = obuf->data[0];
+  obuf->data[0] = p->conv_cb (obuf->data[0], p->samplerate, p->bufsize);
+  return AUBIO_OK;
+}
+
+/* batched processing, each job runs a contiguous segment of frames */
+typedef struct
+{
+  aubio_pitch_t *p;               /**< detector owned by this job */
+  const fvec_t *in;               /**< whole input signal */
+  uint_t hop_size;                /**< hop size */
+  uint_t start;                   /**< first frame to output */
+  uint_t end;                     /**< last frame to output, excluded */
+  fvec_t *pitch;                  /**< output pitch track */
+  fvec_t *confidence;             /**< output confidence track, can be NULL */
+} aubio_pitch_job_t;
+
+static void *
+aubio_pitch_do_job (void * arg)
+{
+  aubio_pitch_job_t *job = (aubio_pitch_job_t *)arg;
+  aubio_pitch_t *p = job->p;
+  fvec_t hop, out;
+  smpl_t outval = 0.;
+  // enough frames to fill the sliding buffer, plus one for fcomb phase
+  uint_t warmup = (p->bufsize + job->hop_size - 1) / job->hop_size;
+  uint_t first = job->start > warmup ? job->start - warmup : 0;
+  uint_t i;
+  hop.length = job->hop_size;
+  out.length = 1;
+  out.data = &outval;
+  aubio_pitch_reset (p);
+  for (i = first; i < job->end; i++) {
+    hop.data = job->in->data + i * job->hop_size;
+    aubio_pitch_do (p, &hop, &out);
+    if (i < job->start) continue;
+    job->pitch->data[i] = outval;
+    if (job->confidence) {
+      job->confidence->data[i] = aubio_pitch_get_confidence (p);
+    }
+  }
+  return NULL;
+}
+
+/* forget all previous frames, so that each job gives the same results whatever
+   detector runs it and whatever it analysed before */
+void
+aubio_pitch_reset (aubio_pitch_t * p)
+{
+  if (p->buf) fvec_zeros (p->buf);
+  p->silent = 0;
+  p->last_freq = 0.;
+  switch (p->type) {
+    case aubio_pitcht_mcomb:
+      aubio_filter_do_reset (p->filter);
+      aubio_pvoc_reset (p->pv);
+      aubio_pitchmcomb_reset (p->p_object);
+      break;
+    case aubio_pitcht_schmitt:
+      aubio_pitchschmitt_reset (p->p_object);
+      break;
+    case aubio_pitcht_fcomb:
+      aubio_pitchfcomb_reset (p->p_object);
+      break;
+    case aubio_pitcht_pyin:
+      aubio_pitchpyin_reset (p->p_object);
+      break;
+    default:
+      // the other methods compute each frame from the buffer alone
+      break;
+  }
+}
+
+uint_t
+aubio_pitch_set_threads (aubio_pitch_t * p, uint_t nthreads)
+{
+  if (nthreads > AUBIO_PITCH_MAX_THREADS) {
+    AUBIO_WRN("pitch: could not set threads to %d, maximum is %d\n",
+        nthreads, AUBIO_PITCH_MAX_THREADS);
+    return AUBIO_FAIL;
+  }
+  p->nthreads = nthreads;
+  return AUBIO_OK;
+}
+
+uint_t
+aubio_pitch_get_threads (aubio_pitch_t * p, uint_t nframes, uint_t hop_size)
+{
+  uint_t nthreads = p->nthreads;
+#ifdef HAVE_PTHREAD_H
+  if (nthreads == 0) {
+#if defined(HAVE_UNISTD_H) && defined(_SC_NPROCESSORS_ONLN)
+    long ncpus = sysconf (_SC_NPROCESSORS_ONLN);
+    nthreads = ncpus > 0 ? (uint_t)ncpus : 1;
+#else
+    nthreads = 1;
+#endif
+  }
+  nthreads = MIN(nthreads, AUBIO_PITCH_MAX_THREADS);
+#else
+  nthreads = 1;
+#endif
+  // mcomb and pyin keep tracking state from one frame to the next
+  if (p->type == aubio_pitcht_mcomb || p->type == aubio_pitcht_pyin) nthreads = 1;
+  // keep segments much longer than the warmup
+  nthreads = MIN(nthreads, nframes / (4 * (p->bufsize / hop_size + 1)) + 1);
+  return MAX(nthreads, 1);
+}
+
+void
+aubio_pitch_del_workers (aubio_pitch_t * p)
+{
+  uint_t i;
+  for (i = 0; i < p->nworkers; i++) {
+    del_aubio_pitch (p->workers[i]);
+  }
+  if (p->workers) AUBIO_FREE (p->workers);
+  p->workers = NULL;
+  p->nworkers = 0;
+}
+
+uint_t
+aubio_pitch_do_multi (aubio_pitch_t * p, const fvec_t * in, uint_t hop_size,
+    fvec_t * pitch, fvec_t * confidence)
+{
+  aubio_pitch_job_t jobs[AUBIO_PITCH_MAX_THREADS];
+  uint_t nframes, nthreads, i;
+  if ((sint_t)hop_size < 1 || hop_size > p->bufsize) {
+    AUBIO_ERR("pitch: got hop size %d, expected between 1 and %d\n",
+        hop_size, p->bufsize);
+    return AUBIO_FAIL;
+  }
+  nframes = in->length / hop_size;
+  if (pitch->length < nframes || (confidence && confidence->length < nframes)) {
+    AUBIO_ERR("pitch: output tracks need at least %d elements\n", nframes);
+    return AUBIO_FAIL;
+  }
+  if (nframes == 0) return AUBIO_OK;
+  nthreads = aubio_pitch_get_threads (p, nframes, hop_size);
+
+  // the calling thread runs the last segment with p itself, other segments
+  // use detector copies that are kept around for the next call
+  if (p->nworkers < nthreads - 1) {
+    aubio_pitch_del_workers (p);
+    p->workers = AUBIO_ARRAY (aubio_pitch_t *, nthreads - 1);
+    for (i = 0; i < nthreads - 1; i++) {
+      p->workers[i] = new_aubio_pitch (aubio_pitch_methods[p->type],
+          p->bufsize, p->hopsize, p->samplerate);
+      if (!p->workers[i]) break;
+      p->nworkers++;
+    }
+    if (p->nworkers < nthreads - 1) {
+      nthreads = p->nworkers + 1;
+    }
+  }
+  for (i = 0; i < nthreads; i++) {
+    aubio_pitch_t *w = (i + 1 < nthreads) ? p->workers[i] : p;
+    if (w != p) {
+      w->mode = p->mode;
+      w->conv_cb = p->conv_cb;
+      w->silence = p->silence;
+      aubio_pitch_set_tolerance (w, aubio_pitch_get_tolerance (p));
+    }
+    jobs[i].p = w;
+    jobs[i].in = in;
+    jobs[i].hop_size = hop_size;
+    jobs[i].start = (uint_t)((unsigned long long)nframes * i / nthreads);
+    jobs[i].end = (uint_t)((unsigned long long)nframes * (i + 1) / nthreads);
+    jobs[i].pitch = pitch;
+    jobs[i].confidence = confidence;
+  }
+
+#ifdef HAVE_PTHREAD_H
+  {
+    pthread_t threads[AUBIO_PITCH_MAX_THREADS];
+    uint_t started[AUBIO_PITCH_MAX_THREADS];
+    for (i = 0; i + 1 < nthreads; i++) {
+      started[i] = pthread_create (&threads[i], NULL, aubio_pitch_do_job,
+          &jobs[i]) == 0;
+      // fallback to running the segment here if the thread failed to start
+      if (!started[i]) aubio_pitch_do_job (&jobs[i]);
+    }
+    aubio_pitch_do_job (&jobs[nthreads - 1]);
+    for (i = 0; i + 1 < nthreads; i++) {
+      if (started[i]) pthread_join (threads[i], NULL);
+    }
+  }
+#else
+  for (i = 0; i < nthreads; i++) {
+    aubio_pitch_do_job (&jobs[i]);
+  }
+#endif
+  return AUBIO_OK;
+}
+
 /* do method for each algorithm */
 void
 aubio_pitch_do_mcomb (aubio_pitch_t * p, const fvec_t * ibuf, fvec_t * obuf)
@@ -477,6 +810,51 @@ aubio_pitch_do_specacf (aubio_pitch_t * p, const fvec_t * ibuf, fvec_t * out)
   out->data[0] = pitch;
 }
 
+void
+aubio_pitch_do_dual (aubio_pitch_t * p, const fvec_t * ibuf, fvec_t * out)
+{
+  aubio_pitchdual_t *d = (aubio_pitchdual_t *)p->p_object;
+  smpl_t period, fast_period, fast_conf, fft_period, fft_conf, ratio;
+  aubio_pitch_slideblock (p, ibuf);
+  // one forward transform for both estimates
+  aubio_fft_do_complex (d->fft, p->buf, d->compspec);
+  aubio_pitchyinfast_do_complex (d->yinfast, p->buf, d->compspec, out);
+  aubio_pitchyinfft_do_complex (d->yinfft, d->compspec, d->cands);
+  fast_period = out->data[0];
+  fast_conf = aubio_pitchyinfast_get_confidence (d->yinfast);
+  fft_period = d->cands->data[0];
+  fft_conf = aubio_pitchyinfft_get_confidence (d->yinfft);
+  ratio = (fast_period > 0 && fft_period > 0) ? fast_period / fft_period : 0.;
+  if (ratio > 0.97 && ratio < 1.03) {
+    // both agree, keep the first dip estimate
+    period = fast_period;
+    d->confidence = MAX (fast_conf, fft_conf);
+  } else if (fft_conf > fast_conf) {
+    // usually an octave error of the first dip
+    period = fft_period;
+    d->confidence = .5 * fft_conf;
+  } else {
+    period = fast_period;
+    d->confidence = .5 * fast_conf;
+  }
+  out->data[0] = period > 0 ? p->samplerate / period : 0.;
+}
+
+void
+aubio_pitch_do_pyin (aubio_pitch_t * p, const fvec_t * ibuf, fvec_t * out)
+{
+  smpl_t period;
+  aubio_pitch_slideblock (p, ibuf);
+  // silent frames still advance the decoder
+  if (aubio_silence_detection (ibuf, p->silence) == 1) {
+    aubio_pitchpyin_do_unvoiced (p->p_object, out);
+  } else {
+    aubio_pitchpyin_do (p->p_object, p->buf, out);
+  }
+  period = out->data[0];
+  out->data[0] = period > 0 ? p->samplerate / period : 0.;
+}
+
 void
 aubio_pitch_do_fcomb (aubio_pitch_t * p, const fvec_t * ibuf, fvec_t * out)
 {
@@ -500,6 +878,42 @@ aubio_pitch_do_schmitt (aubio_pitch_t * p, const fvec_t * ibuf, fvec_t * out)
   out->data[0] = pitch;
 }
 
+/* dual detector */
+aubio_pitchdual_t *
+new_aubio_pitchdual (uint_t samplerate, uint_t bufsize)
+{
+  aubio_pitchdual_t *d = AUBIO_NEW (aubio_pitchdual_t);
+  d->yinfast = new_aubio_pitchyinfast (bufsize);
+  d->yinfft = new_aubio_pitchyinfft (samplerate, bufsize);
+  d->fft = new_aubio_fft (bufsize);
+  if (!d->yinfast || !d->yinfft || !d->fft) {
+    del_aubio_pitchdual (d);
+    return NULL;
+  }
+  d->compspec = new_fvec (bufsize);
+  d->cands = new_fvec (1);
+  aubio_pitchyinfast_set_tolerance (d->yinfast, 0.15);
+  aubio_pitchyinfft_set_tolerance (d->yinfft, 0.85);
+  return d;
+}
+
+void
+del_aubio_pitchdual (aubio_pitchdual_t * d)
+{
+  if (d->yinfast) del_aubio_pitchyinfast (d->yinfast);
+  if (d->yinfft) del_aubio_pitchyinfft (d->yinfft);
+  if (d->fft) del_aubio_fft (d->fft);
+  if (d->compspec) del_fvec (d->compspec);
+  if (d->cands) del_fvec (d->cands);
+  AUBIO_FREE (d);
+}
+
+smpl_t
+aubio_pitchdual_get_confidence (aubio_pitchdual_t * d)
+{
+  return d->confidence;
+}
+
 /* conversion callbacks */
 smpl_t
 freqconvbin(smpl_t f, uint_t samplerate, uint_t bufsize)
@@ -528,3 +942,65 @@ aubio_pitch_get_confidence (aubio_pitch_t * p)
   }
   return 0.;
 }
+
+uint_t
+aubio_pitch_get_candidates (aubio_pitch_t * p, uint_t k, fvec_t * freqs,
+    fvec_t * confidences)
+{
+  fvec_t periods, confs;
+  uint_t i, j, count;
+  smpl_t period, ratio;
+  if (freqs->length < k || confidences->length < k) {
+    AUBIO_ERR ("pitch: can not get %d candidates in vectors of size %d and %d\n",
+        k, freqs->length, confidences->length);
+    return 0;
+  }
+  if (k == 0 || p->silent == 1) return 0;
+  // views on the first k elements, periods are converted in place below
+  periods.data = freqs->data;
+  periods.length = k;
+  confs.data = confidences->data;
+  confs.length = k;
+  switch (p->type) {
+    case aubio_pitcht_yin:
+      count = aubio_pitchyin_get_candidates (p->p_object, &periods, &confs);
+      break;
+    case aubio_pitcht_yinfft:
+      count = aubio_pitchyinfft_get_candidates (p->p_object, &periods, &confs);
+      break;
+    case aubio_pitcht_yinfast:
+      count = aubio_pitchyinfast_get_candidates (p->p_object, &periods, &confs);
+      break;
+    case aubio_pitcht_dual:
+      count = aubio_pitchyinfast_get_candidates (
+          ((aubio_pitchdual_t *)p->p_object)->yinfast, &periods, &confs);
+      break;
+    default:
+      // no YIN function, the estimate itself is the only candidate
+      count = 0;
+      break;
+  }
+  if (p->last_freq > 0) {
+    // the estimate comes first, remove the minimum it was taken from
+    period = p->samplerate / p->last_freq;
+    for (i = 0, j = 0; i < count; i++) {
+      ratio = freqs->data[i] / period;
+      if (ratio > 0.97 && ratio < 1.03) continue;
+      freqs->data[j] = freqs->data[i];
+      confidences->data[j] = confidences->data[i];
+      j++;
+    }
+    count = MIN(j + 1, k);
+    for (i = count - 1; i > 0; i--) {
+      freqs->data[i] = freqs->data[i - 1];
+      confidences->data[i] = confidences->data[i - 1];
+    }
+    freqs->data[0] = period;
+    confidences->data[0] = aubio_pitch_get_confidence (p);
+  }
+  for (i = 0; i < count; i++) {
+    freqs->data[i] = p->conv_cb (p->samplerate / freqs->data[i],
+        p->samplerate, p->bufsize);
+  }
+  return count;
+}
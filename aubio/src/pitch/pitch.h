@@ -97,6 +97,23 @@ extern "C" {
   systems](http://aubio.org/phd/), Chapter 3, Pitch Analysis, PhD thesis,
   Centre for Digital music, Queen Mary University of London, London, UK, 2006.
 
+  \b \p dual : Yinfast confirmed by Yinfft
+
+  Runs \p yinfast and \p yinfft on the same frame, computing the forward
+  Fourier transform of the input only once: the window used by \p yinfft is
+  applied in the spectral domain. When both estimates agree within half a
+  semitone, the \p yinfast estimate is kept, with the highest of the two
+  confidences. Otherwise, the most confident estimate is kept, and its
+  confidence halved. The tolerance applies to \p yinfast .
+
+  \b \p pyin : Probabilistic YIN
+
+  Applies a distribution of thresholds to the \p yinfast function, and tracks
+  the resulting candidates with a hidden Markov model decoded in real time, see
+  pitch/pitchpyin.h. Each estimate is that of the frame a few hops in the past,
+  set with aubio_pitch_set_lag(). The tolerance is the mean of the threshold
+  distribution, 0.15 by default.
+
   \example pitch/test-pitch.c
   \example examples/aubiopitch.c
 
@@ -114,6 +131,61 @@ typedef struct _aubio_pitch_t aubio_pitch_t;
 */
 void aubio_pitch_do (aubio_pitch_t * o, const fvec_t * in, fvec_t * out);
 
+/** execute pitch detection on an input signal frame and its spectrum
+
+  \param o pitch detection object as returned by new_aubio_pitch()
+  \param in input signal of size [hop_size]
+  \param spectrum spectral frame of the last [buf_size] samples, as computed
+  by aubio_pvoc_do() or a shared ::aubio_frontend_t with the same buffer and
+  hop sizes
+  \param out output pitch candidates of size [1]
+
+  \p yinfft and \p mcomb use the given spectrum instead of computing their own
+  FFT. The other methods ignore it and behave like aubio_pitch_do(). Do not mix
+  calls to this function and aubio_pitch_do() on the same object.
+
+  \return 0 if successful, non-zero if the spectrum size does not match
+
+*/
+uint_t aubio_pitch_do_spectrum (aubio_pitch_t * o, const fvec_t * in,
+    const cvec_t * spectrum, fvec_t * out);
+
+/** execute pitch detection on a whole signal
+
+  \param o pitch detection object as returned by new_aubio_pitch()
+  \param in input signal, of any length
+  \param hop_size step size between two consecutive frames
+  \param pitch output pitch track, of size [in->length / hop_size] or more
+  \param confidence output confidence track, same size as pitch, or NULL
+
+  The signal is analysed as if aubio_pitch_do() had been called on each of its
+  consecutive hops of a new detector: nothing from previous calls is kept,
+  and the results do not depend on the number of threads. Frames are split in
+  contiguous segments processed in parallel, each thread using its own copy of
+  the detector. These copies are kept and reused in the next calls.
+
+  \p mcomb and \p pyin keep tracking state from one frame to the next, their
+  frames are always processed in order on the calling thread. The \p pyin
+  decoder starts again at each call: as with aubio_pitch_do(), each output is
+  the decision on the frame aubio_pitch_get_lag() frames earlier, and the
+  first outputs of a call are 0, never decoded from the previous signal.
+
+  \return 0 if successful, non-zero otherwise
+
+*/
+uint_t aubio_pitch_do_multi (aubio_pitch_t * o, const fvec_t * in,
+    uint_t hop_size, fvec_t * pitch, fvec_t * confidence);
+
+/** set the number of threads used by aubio_pitch_do_multi()
+
+  \param o pitch detection object as returned by new_aubio_pitch()
+  \param nthreads number of threads, 0 to use one per processor (default)
+
+  \return 0 if successful, non-zero otherwise
+
+*/
+uint_t aubio_pitch_set_threads (aubio_pitch_t * o, uint_t nthreads);
+
 /** change yin or yinfft tolerance threshold
 
   \param o pitch detection object as returned by new_aubio_pitch()
@@ -130,6 +202,27 @@ uint_t aubio_pitch_set_tolerance (aubio_pitch_t * o, smpl_t tol);
 */
 smpl_t aubio_pitch_get_tolerance (aubio_pitch_t * o);
 
+/** set the number of frames \p pyin decisions are delayed by
+
+  \param o pitch detection object as returned by new_aubio_pitch()
+  \param lag number of frames, up to 32 [default 4]
+
+  A longer lag lets the decoder correct more errors, at the cost of latency.
+
+  \return 0 if successful, non-zero otherwise, or if the method is not \p pyin
+
+*/
+uint_t aubio_pitch_set_lag (aubio_pitch_t * o, uint_t lag);
+
+/** get the number of frames \p pyin decisions are delayed by
+
+  \param o pitch detection object as returned by new_aubio_pitch()
+
+  \return number of frames, 0 for methods other than \p pyin
+
+*/
+uint_t aubio_pitch_get_lag (aubio_pitch_t * o);
+
 /** deletion of the pitch detection object
 
   \param o pitch detection object as returned by new_aubio_pitch()
@@ -190,6 +283,28 @@ smpl_t aubio_pitch_get_silence (aubio_pitch_t * o);
 */
 smpl_t aubio_pitch_get_confidence (aubio_pitch_t * o);
 
+/** get the best pitch candidates of the last frame
+
+  \param o pitch detection object as returned by new_aubio_pitch()
+  \param k number of candidates to get
+  \param freqs output candidates, in the unit set with aubio_pitch_set_unit(),
+  of size [k] or more
+  \param confidences output confidence of each candidate, of size [k] or more
+
+  The first candidate is the estimate returned by aubio_pitch_do(), when one
+  was found. It is followed by the deepest other minima of the YIN function
+  already computed by \p yin, \p yinfast, \p yinfft and \p dual (which uses
+  the \p yinfast function) for the last frame, sorted by decreasing
+  confidence, so that octave alternatives of the estimate are available
+  without running another detector. The other methods return their estimate
+  only. No candidates are returned for silent frames.
+
+  \return number of candidates written, up to `k`
+
+*/
+uint_t aubio_pitch_get_candidates (aubio_pitch_t * o, uint_t k, fvec_t * freqs,
+    fvec_t * confidences);
+
 #ifdef __cplusplus
 }
 #endif
@@ -29,6 +29,9 @@
 
 #define MAX_PEAKS 8
 
+/* lowest level of a peak, in dB */
+#define MIN_PEAK_DB -200.
+
 typedef struct
 {
   smpl_t bin;
@@ -42,11 +45,21 @@ struct _aubio_pitchfcomb_t
   uint_t rate;
   fvec_t *winput;
   fvec_t *win;
-  cvec_t *fftOut;
-  fvec_t *fftLastPhase;
+  fvec_t *fftOut;               /**< complex spectrum of the current frame */
+  fvec_t *fftLast;              /**< complex spectrum of the previous frame */
   aubio_fft_t *fft;
 };
 
+/* real and imaginary parts of bin k of a spectrum from aubio_fft_do_complex */
+static void
+aubio_pitchfcomb_get_bin (const fvec_t * compspec, uint_t k, smpl_t * re,
+    smpl_t * im)
+{
+  *re = compspec->data[k];
+  *im = (k == 0 || 2 * k == compspec->length) ? 0. :
+      compspec->data[compspec->length - k];
+}
+
 aubio_pitchfcomb_t *
 new_aubio_pitchfcomb (uint_t bufsize, uint_t hopsize)
 {
@@ -56,8 +69,9 @@ new_aubio_pitchfcomb (uint_t bufsize, uint_t hopsize)
   p->fft = new_aubio_fft (bufsize);
   if (!p->fft) goto beach;
   p->winput = new_fvec (bufsize);
-  p->fftOut = new_cvec (bufsize);
-  p->fftLastPhase = new_fvec (bufsize);
+  p->fftOut = new_fvec (bufsize);
+  p->fftLast = new_fvec (bufsize);
+  aubio_pitchfcomb_reset (p);
   p->win = new_aubio_window ("hanning", bufsize);
   return p;
 
@@ -72,27 +86,39 @@ aubio_pitchfcomb_do (aubio_pitchfcomb_t * p, const fvec_t * input, fvec_t * outp
 {
   uint_t k, l, maxharm = 0;
   smpl_t phaseDifference = TWO_PI * (smpl_t) p->stepSize / (smpl_t) p->fftSize;
+  /* magnitudes are compared as squared norms, 20 log10 (2 norm / fftSize)
+   * is only computed for the peaks that were kept */
+  smpl_t powerScale = 4. / ((smpl_t) p->fftSize * (smpl_t) p->fftSize);
+  smpl_t maxPower = POW (10., MIN_PEAK_DB / 10.) / powerScale;
+  /* last peaks found, as a ring starting at index first */
+  smpl_t peakBin[MAX_PEAKS], peakPower[MAX_PEAKS];
+  uint_t first = 0;
   aubio_fpeak_t peaks[MAX_PEAKS];
+  fvec_t *spectrum = p->fftOut;
+  fvec_t *last = p->fftLast;
 
   for (k = 0; k < MAX_PEAKS; k++) {
-    peaks[k].db = -200.;
-    peaks[k].bin = 0.;
+    peakPower[k] = maxPower;
+    peakBin[k] = 0.;
   }
 
   for (k = 0; k < input->length; k++) {
     p->winput->data[k] = p->win->data[k] * input->data[k];
   }
-  aubio_fft_do (p->fft, p->winput, p->fftOut);
+  aubio_fft_do_complex (p->fft, p->winput, spectrum);
 
   for (k = 0; k <= p->fftSize / 2; k++) {
-    smpl_t
-        magnitude =
-        20. * LOG10 (2. * p->fftOut->norm[k] / (smpl_t) p->fftSize),
-        phase = p->fftOut->phas[k], tmp, bin;
+    smpl_t re, im, lastRe, lastIm, power, tmp, bin;
 
-    /* compute phase difference */
-    tmp = phase - p->fftLastPhase->data[k];
-    p->fftLastPhase->data[k] = phase;
+    aubio_pitchfcomb_get_bin (spectrum, k, &re, &im);
+    power = re * re + im * im;
+    /* only louder bins than the last peak can become a new one */
+    if (power <= maxPower)
+      continue;
+
+    /* compute phase difference from the previous frame */
+    aubio_pitchfcomb_get_bin (last, k, &lastRe, &lastIm);
+    tmp = ATAN2 (im * lastRe - re * lastIm, re * lastRe + im * lastIm);
 
     /* subtract expected phase difference */
     tmp -= (smpl_t) k *phaseDifference;
@@ -106,13 +132,24 @@ aubio_pitchfcomb_do (aubio_pitchfcomb_t * p, const fvec_t * input, fvec_t * outp
     /* compute the k-th partials' true bin */
     bin = (smpl_t) k + tmp;
 
-    if (bin > 0.0 && magnitude > peaks[0].db) {       // && magnitude < 0) {
-      memmove (peaks + 1, peaks, sizeof (aubio_fpeak_t) * (MAX_PEAKS - 1));
-      peaks[0].bin = bin;
-      peaks[0].db = magnitude;
+    if (bin > 0.0) {
+      first = (first + MAX_PEAKS - 1) % MAX_PEAKS;
+      peakBin[first] = bin;
+      peakPower[first] = power;
+      maxPower = power;
     }
   }
 
+  /* keep this spectrum for the next frame */
+  p->fftOut = last;
+  p->fftLast = spectrum;
+
+  for (k = 0; k < MAX_PEAKS; k++) {
+    l = (first + k) % MAX_PEAKS;
+    peaks[k].bin = peakBin[l];
+    peaks[k].db = 10. * LOG10 (powerScale * peakPower[l]);
+  }
+
   k = 0;
   for (l = 1; l < MAX_PEAKS && peaks[l].bin > 0.0; l++) {
     sint_t harmonic;
@@ -132,11 +169,21 @@ aubio_pitchfcomb_do (aubio_pitchfcomb_t * p, const fvec_t * input, fvec_t * outp
     output->data[0] = 0.;
 }
 
+void
+aubio_pitchfcomb_reset (aubio_pitchfcomb_t * p)
+{
+  uint_t k, bufsize = p->fftLast->length;
+  /* the previous frame starts with a null phase in every bin */
+  fvec_set_all (p->fftLast, 1.);
+  for (k = 1; k < (bufsize + 1) / 2; k++)
+    p->fftLast->data[bufsize - k] = 0.;
+}
+
 void
 del_aubio_pitchfcomb (aubio_pitchfcomb_t * p)
 {
-  del_cvec (p->fftOut);
-  del_fvec (p->fftLastPhase);
+  del_fvec (p->fftOut);
+  del_fvec (p->fftLast);
   del_fvec (p->win);
   del_fvec (p->winput);
   del_aubio_fft (p->fft);
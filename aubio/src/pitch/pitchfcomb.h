@@ -69,6 +69,13 @@ aubio_pitchfcomb_t *new_aubio_pitchfcomb (uint_t buf_size, uint_t hop_size);
 */
 void del_aubio_pitchfcomb (aubio_pitchfcomb_t * p);
 
+/** reset the pitch detection object, forgetting the previous frame
+
+  \param p pitch detection object as returned by new_aubio_pitchfcomb
+
+*/
+void aubio_pitchfcomb_reset (aubio_pitchfcomb_t * p);
+
 #ifdef __cplusplus
 }
 #endif
@@ -33,6 +33,7 @@ uint_t aubio_pitchmcomb_get_root_peak (aubio_spectralpeak_t * peaks,
 uint_t aubio_pitchmcomb_quadpick (aubio_spectralpeak_t * spectral_peaks,
     const fvec_t * X);
 void aubio_pitchmcomb_spectral_pp (aubio_pitchmcomb_t * p, const fvec_t * oldmag);
+static void aubio_pitchmcomb_adapt_thres (aubio_pitchmcomb_t * p, fvec_t * mag);
 void aubio_pitchmcomb_combdet (aubio_pitchmcomb_t * p, const fvec_t * newmag);
 /* not used but useful : sort by amplitudes (or anything else)
  * sort_pitchpeak(peaks, length);
@@ -73,10 +74,8 @@ struct _aubio_pitchmcomb_t
   aubio_spectralpeak_t *peaks;             /**< up to length win/spec_partition      */
   aubio_spectralcandidate_t **candidates;  /** up to five candidates                 */
   /* some scratch pads */
-  /** \bug  (unnecessary copied from fftgrain?) */
-  fvec_t *newmag;                          /**< vec to store mag                     */
   fvec_t *scratch;                         /**< vec to store modified mag            */
-  fvec_t *scratch2;                        /**< vec to compute moving median         */
+  aubio_median_t *median;                  /**< moving median of the threshold       */
   fvec_t *theta;                          /**< vec to store phase                     */
   smpl_t phasediff;
   smpl_t phasefreq;
@@ -109,16 +108,16 @@ aubio_pitchmcomb_do (aubio_pitchmcomb_t * p, const cvec_t * fftgrain, fvec_t * o
 {
   uint_t j;
   smpl_t instfreq;
-  fvec_t *newmag = (fvec_t *) p->newmag;
+  fvec_t newmag;
   //smpl_t hfc; //fe=instfreq(theta1,theta,ops); //theta1=theta;
-  /* copy incoming grain to newmag */
-  for (j = 0; j < newmag->length; j++)
-    newmag->data[j] = fftgrain->norm[j];
+  /* read the incoming grain in place */
+  newmag.length = fftgrain->length;
+  newmag.data = fftgrain->norm;
   /* detect only if local energy > 10. */
   //if (aubio_level_lin (newmag) * newmag->length > 10.) {
   //hfc = fvec_local_hfc(newmag); //not used
-  aubio_pitchmcomb_spectral_pp (p, newmag);
-  aubio_pitchmcomb_combdet (p, newmag);
+  aubio_pitchmcomb_spectral_pp (p, &newmag);
+  aubio_pitchmcomb_combdet (p, &newmag);
   //aubio_pitchmcomb_sort_cand_freq(p->candidates,p->ncand);
   //return p->candidates[p->goodcandidate]->ebin;
   j = (uint_t) FLOOR (p->candidates[p->goodcandidate]->ebin + .5);
@@ -126,9 +125,7 @@ aubio_pitchmcomb_do (aubio_pitchmcomb_t * p, const cvec_t * fftgrain, fvec_t * o
       - p->theta->data[j] - j * p->phasediff);
   instfreq *= p->phasefreq;
   /* store phase for next run */
-  for (j = 0; j < p->theta->length; j++) {
-    p->theta->data[j] = fftgrain->phas[j];
-  }
+  memcpy (p->theta->data, fftgrain->phas, p->theta->length * sizeof (smpl_t));
   //return p->candidates[p->goodcandidate]->ebin;
   output->data[0] =
       FLOOR (p->candidates[p->goodcandidate]->ebin + .5) + instfreq;
@@ -174,34 +171,56 @@ void
 aubio_pitchmcomb_spectral_pp (aubio_pitchmcomb_t * p, const fvec_t * newmag)
 {
   fvec_t *mag = (fvec_t *) p->scratch;
-  fvec_t *tmp = (fvec_t *) p->scratch2;
   uint_t j;
-  uint_t length = mag->length;
   /* copy newmag to mag (scracth) */
-  for (j = 0; j < length; j++) {
-    mag->data[j] = newmag->data[j];
-  }
+  fvec_copy (newmag, mag);
   fvec_min_removal (mag);       /* min removal          */
   fvec_alpha_normalise (mag, p->alpha); /* alpha normalisation  */
   /* skipped *//* low pass filtering   */
-  /** \bug fvec_moving_thres may write out of bounds */
-  fvec_adapt_thres (mag, tmp, p->win_post, p->win_pre);      /* adaptative threshold */
+  aubio_pitchmcomb_adapt_thres (p, mag);        /* adaptative threshold */
   fvec_add (mag, -p->threshold);        /* fixed threshold      */
   {
     aubio_spectralpeak_t *peaks = (aubio_spectralpeak_t *) p->peaks;
     uint_t count;
     /*  return bin and ebin */
     count = aubio_pitchmcomb_quadpick (peaks, mag);
+    /* only the first count peaks are read afterwards */
     for (j = 0; j < count; j++)
       peaks[j].mag = newmag->data[peaks[j].bin];
-    /* reset non peaks */
-    for (j = count; j < length; j++)
-      peaks[j].mag = 0.;
     p->peaks = peaks;
     p->count = count;
   }
 }
 
+/* same as fvec_adapt_thres (mag, tmp, win_post, win_pre), with a sliding
+ * median instead of sorting a window for each bin. Like fvec_moving_thres,
+ * the first bin and bins past the end count as zeros, and the window holds
+ * the thresholded values of the bins already done. */
+static void
+aubio_pitchmcomb_adapt_thres (aubio_pitchmcomb_t * p, fvec_t * mag)
+{
+  aubio_median_t *median = p->median;
+  uint_t length = mag->length;
+  uint_t post = p->win_post, pre = p->win_pre;
+  uint_t j;
+  smpl_t thres;
+  aubio_median_reset (median);
+  /* window of bin 0, from -post to pre */
+  for (j = 0; j < post + 1; j++)
+    aubio_median_do (median, 0.);
+  for (j = 1; j <= pre; j++)
+    aubio_median_do (median, j < length ? mag->data[j] : 0.);
+  for (j = 0; j < length; j++) {
+    thres = aubio_median_get (median);
+    mag->data[j] -= thres;
+    /* bin j is pre values before the last one pushed */
+    if (j > 0)
+      aubio_median_set (median, pre, mag->data[j]);
+    aubio_median_do (median, j + pre + 1 < length ?
+        mag->data[j + pre + 1] : 0.);
+  }
+}
+
 void
 aubio_pitchmcomb_combdet (aubio_pitchmcomb_t * p, const fvec_t * newmag)
 {
@@ -216,7 +235,7 @@ aubio_pitchmcomb_combdet (aubio_pitchmcomb_t * p, const fvec_t * newmag)
   uint_t count = p->count;
   uint_t k;
   uint_t l;
-  uint_t d;
+  uint_t lo, hi, mid;
   uint_t curlen = 0;
 
   smpl_t delta2;
@@ -243,20 +262,34 @@ aubio_pitchmcomb_combdet (aubio_pitchmcomb_t * p, const fvec_t * newmag)
       curlen = (uint_t) FLOOR (length / (candidate[l]->ebin));
     curlen = (N < curlen) ? N : curlen;
     /* fill candidate[l]->ecomb[k] with (k+1)*candidate[l]->ebin */
+    /* only the first curlen elements of ecomb are used */
     for (k = 0; k < curlen; k++)
       candidate[l]->ecomb[k] = (candidate[l]->ebin) * (k + 1.);
-    for (k = curlen; k < length; k++)
-      candidate[l]->ecomb[k] = 0.;
     /* for each in candidate[l]->ecomb[k] */
     for (k = 0; k < curlen; k++) {
       xx = 100000.;
       /** get the candidate->ecomb the closer to peaks.ebin
        * (to cope with the inharmonicity)*/
-      for (d = 0; d < count; d++) {
-        delta2 = ABS (candidate[l]->ecomb[k] - peaks[d].ebin);
-        if (delta2 <= xx) {
-          position = d;
-          xx = delta2;
+      if (count > 0) {
+        /* peaks are sorted by ebin: find the first one above ecomb, the
+         * closest is either this one or the one before, the later on ties */
+        lo = 0;
+        hi = count;
+        while (lo < hi) {
+          mid = (lo + hi) / 2;
+          if (peaks[mid].ebin <= candidate[l]->ecomb[k])
+            lo = mid + 1;
+          else
+            hi = mid;
+        }
+        position = lo < count ? lo : count - 1;
+        xx = ABS (candidate[l]->ecomb[k] - peaks[position].ebin);
+        if (lo > 0) {
+          delta2 = ABS (candidate[l]->ecomb[k] - peaks[lo - 1].ebin);
+          if (delta2 < xx) {
+            position = lo - 1;
+            xx = delta2;
+          }
         }
       }
       /* for a Q factor of 17, maintaining "constant Q filtering",
@@ -387,13 +420,12 @@ new_aubio_pitchmcomb (uint_t bufsize, uint_t hopsize)
   //p->pickerfn = quadpick;
   //p->biquad = new_biquad(0.1600,0.3200,0.1600, -0.5949, 0.2348);
   /* allocate temp memory */
-  p->newmag = new_fvec (spec_size);
   /* array for median */
   p->scratch = new_fvec (spec_size);
   /* array for phase */
   p->theta = new_fvec (spec_size);
-  /* array for adaptative threshold */
-  p->scratch2 = new_fvec (p->win_post + p->win_pre + 1);
+  /* moving median for adaptative threshold */
+  p->median = new_aubio_median (p->win_post + p->win_pre + 1);
   /* array of spectral peaks */
   p->peaks = AUBIO_ARRAY (aubio_spectralpeak_t, spec_size);
   for (i = 0; i < spec_size; i++) {
@@ -417,14 +449,19 @@ new_aubio_pitchmcomb (uint_t bufsize, uint_t hopsize)
 }
 
 
+void
+aubio_pitchmcomb_reset (aubio_pitchmcomb_t * p)
+{
+  fvec_zeros (p->theta);
+}
+
 void
 del_aubio_pitchmcomb (aubio_pitchmcomb_t * p)
 {
   uint_t i;
-  del_fvec (p->newmag);
   del_fvec (p->scratch);
   del_fvec (p->theta);
-  del_fvec (p->scratch2);
+  del_aubio_median (p->median);
   AUBIO_FREE (p->peaks);
   for (i = 0; i < p->ncand; i++) {
     AUBIO_FREE (p->candidates[i]->ecomb);
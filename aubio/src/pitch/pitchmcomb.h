@@ -70,6 +70,14 @@ aubio_pitchmcomb_t *new_aubio_pitchmcomb (uint_t buf_size, uint_t hop_size);
 */
 void del_aubio_pitchmcomb (aubio_pitchmcomb_t * p);
 
+/** reset the pitch detection object, forgetting the phases of the previous
+  frame
+
+  \param p pitch detection object as returned by new_aubio_pitchmcomb
+
+*/
+void aubio_pitchmcomb_reset (aubio_pitchmcomb_t * p);
+
 #ifdef __cplusplus
 }
 #endif
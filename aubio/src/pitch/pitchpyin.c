@@ -0,0 +1,478 @@
+/*
+  Copyright (C) 2022 Filipe Coelho <falktx@falktx.com>
+
+  This file is part of aubio.
+
+  aubio is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  aubio is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with aubio.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "aubio_priv.h"
+#include "fvec.h"
+#include "mathutils.h"
+#include "musicutils.h"
+#include "pitch/pitchyinfast.h"
+#include "pitch/pitchpyin.h"
+
+/** number of thresholds in the distribution */
+#define PYIN_THRESHOLDS 100
+/** lowest pitch of the model, as a midi note (E1, 41.2 Hz) */
+#define PYIN_MIN_MIDI 28
+/** number of pitch bins per semitone */
+#define PYIN_BINS_PER_SEMITONE 5
+/** number of pitch bins, 72 semitones up to E7 */
+#define PYIN_BINS (72 * PYIN_BINS_PER_SEMITONE)
+/** number of states, voiced bins followed by unvoiced bins */
+#define PYIN_STATES (2 * PYIN_BINS)
+/** largest pitch change from one frame to the next, in bins */
+#define PYIN_BAND (5 * PYIN_BINS_PER_SEMITONE)
+/** maximum number of period candidates per frame */
+#define PYIN_MAX_CANDIDATES 16
+/** weight of the candidates against the unvoiced states */
+#define PYIN_YIN_TRUST 0.5
+/** probability of staying voiced, or unvoiced, from one frame to the next */
+#define PYIN_VOICING_STAY 0.99
+/** share of the thresholds below every dip given to the global minimum */
+#define PYIN_ABSMIN_PRIOR 0.01
+
+#define PYIN_DEFAULT_TOLERANCE 0.15
+#define PYIN_DEFAULT_LAG 4
+#define PYIN_DEFAULT_BEAM 48
+
+/** period candidates of one frame */
+typedef struct
+{
+  uint_t count;                           /**< number of candidates */
+  uint_t bins[PYIN_MAX_CANDIDATES];       /**< pitch bin of each candidate */
+  smpl_t periods[PYIN_MAX_CANDIDATES];    /**< period, in samples */
+  smpl_t probs[PYIN_MAX_CANDIDATES];      /**< probability */
+  smpl_t voiced;                          /**< sum of all probabilities */
+} aubio_pitchpyin_frame_t;
+
+struct _aubio_pitchpyin_t
+{
+  aubio_pitchyinfast_t *yin;    /**< computes the YIN function */
+  fvec_t *yinout;               /**< yinfast estimate, unused */
+  uint_t samplerate;            /**< samplerate */
+  smpl_t tol;                   /**< mean threshold */
+  smpl_t cumprior[PYIN_THRESHOLDS + 1]; /**< cumulated threshold distribution */
+  smpl_t trans[PYIN_BAND + 1];  /**< pitch transition weight, per distance */
+  smpl_t obs[PYIN_BINS];        /**< voiced observation of each bin */
+  smpl_t *next;                 /**< probability of next states [PYIN_STATES] */
+  uint_t *touched;              /**< next states reached [PYIN_STATES] */
+  uint_t ntouched;              /**< number of next states reached */
+  uint_t *active;               /**< states kept from last frame [PYIN_STATES] */
+  smpl_t *delta;                /**< probability of each active state */
+  uint_t nactive;               /**< number of active states */
+  uint_t *bp;                   /**< back pointers, one row of PYIN_STATES per frame */
+  aubio_pitchpyin_frame_t frames[AUBIO_PITCHPYIN_MAX_LAG + 1]; /**< last frames */
+  uint_t pos;                   /**< ring position of the current frame */
+  uint_t count;                 /**< number of frames decoded, up to lag */
+  uint_t lag;                   /**< decision delay, in frames */
+  uint_t beam;                  /**< maximum number of active states */
+  uint_t transitions;           /**< transitions evaluated in the last frame */
+  smpl_t confidence;            /**< voiced probability of the decided frame */
+};
+
+static smpl_t aubio_pitchpyin_cumprior (const aubio_pitchpyin_t * o, smpl_t x);
+static void aubio_pitchpyin_add_candidate (aubio_pitchpyin_t * o,
+    aubio_pitchpyin_frame_t * f, const fvec_t * yin, uint_t tau, smpl_t prob);
+static void aubio_pitchpyin_get_candidates (aubio_pitchpyin_t * o,
+    const fvec_t * yin, aubio_pitchpyin_frame_t * f);
+static void aubio_pitchpyin_decode (aubio_pitchpyin_t * o, fvec_t * out);
+
+aubio_pitchpyin_t *
+new_aubio_pitchpyin (uint_t samplerate, uint_t bufsize)
+{
+  aubio_pitchpyin_t *o = AUBIO_NEW (aubio_pitchpyin_t);
+  uint_t i;
+  if ((sint_t)samplerate < 1) {
+    AUBIO_ERR ("pitchpyin: samplerate (%d) can not be < 1\n", samplerate);
+    goto beach;
+  }
+  o->yin = new_aubio_pitchyinfast (bufsize);
+  if (!o->yin) goto beach;
+  o->yinout = new_fvec (1);
+  o->samplerate = samplerate;
+  o->next = AUBIO_ARRAY (smpl_t, PYIN_STATES);
+  o->touched = AUBIO_ARRAY (uint_t, PYIN_STATES);
+  o->active = AUBIO_ARRAY (uint_t, PYIN_STATES);
+  o->delta = AUBIO_ARRAY (smpl_t, PYIN_STATES);
+  o->bp = AUBIO_ARRAY (uint_t, (AUBIO_PITCHPYIN_MAX_LAG + 1) * PYIN_STATES);
+  // triangular pitch transitions, as in the original method
+  for (i = 0; i <= PYIN_BAND; i++) {
+    o->trans[i] = (smpl_t)(PYIN_BAND + 1 - i) / SQR(PYIN_BAND + 1);
+  }
+  aubio_pitchpyin_set_tolerance (o, PYIN_DEFAULT_TOLERANCE);
+  o->lag = PYIN_DEFAULT_LAG;
+  o->beam = PYIN_DEFAULT_BEAM;
+  aubio_pitchpyin_reset (o);
+  return o;
+
+beach:
+  AUBIO_FREE (o);
+  return NULL;
+}
+
+void
+del_aubio_pitchpyin (aubio_pitchpyin_t * o)
+{
+  del_aubio_pitchyinfast (o->yin);
+  del_fvec (o->yinout);
+  AUBIO_FREE (o->next);
+  AUBIO_FREE (o->touched);
+  AUBIO_FREE (o->active);
+  AUBIO_FREE (o->delta);
+  AUBIO_FREE (o->bp);
+  AUBIO_FREE (o);
+}
+
+void
+aubio_pitchpyin_reset (aubio_pitchpyin_t * o)
+{
+  uint_t i;
+  for (i = 0; i < PYIN_STATES; i++) {
+    o->next[i] = 0.;
+  }
+  for (i = 0; i < PYIN_BINS; i++) {
+    o->obs[i] = 0.;
+  }
+  o->ntouched = 0;
+  o->nactive = 0;
+  o->pos = 0;
+  o->count = 0;
+  o->transitions = 0;
+  o->confidence = 0.;
+}
+
+void
+aubio_pitchpyin_do (aubio_pitchpyin_t * o, const fvec_t * input, fvec_t * out)
+{
+  aubio_pitchyinfast_do (o->yin, input, o->yinout);
+  aubio_pitchpyin_get_candidates (o, aubio_pitchyinfast_get_yin (o->yin),
+      &o->frames[o->pos]);
+  aubio_pitchpyin_decode (o, out);
+}
+
+void
+aubio_pitchpyin_do_unvoiced (aubio_pitchpyin_t * o, fvec_t * out)
+{
+  o->frames[o->pos].count = 0;
+  o->frames[o->pos].voiced = 0.;
+  aubio_pitchpyin_decode (o, out);
+}
+
+/* sum of the distribution over the thresholds lower than or equal to x */
+smpl_t
+aubio_pitchpyin_cumprior (const aubio_pitchpyin_t * o, smpl_t x)
+{
+  if (x <= 0.) return 0.;
+  if (x >= 1.) return 1.;
+  return o->cumprior[(uint_t)FLOOR(x * PYIN_THRESHOLDS)];
+}
+
+void
+aubio_pitchpyin_add_candidate (aubio_pitchpyin_t * o,
+    aubio_pitchpyin_frame_t * f, const fvec_t * yin, uint_t tau, smpl_t prob)
+{
+  smpl_t period = fvec_quadratic_peak_pos (yin, tau);
+  smpl_t bin = (aubio_freqtomidi (o->samplerate / period) - PYIN_MIN_MIDI)
+    * PYIN_BINS_PER_SEMITONE;
+  uint_t i, b;
+  if (bin < 0. || bin > PYIN_BINS - 1) return;
+  b = (uint_t)ROUND(bin);
+  f->voiced += prob;
+  // candidates falling in the same bin are merged
+  for (i = 0; i < f->count; i++) {
+    if (f->bins[i] == b) {
+      if (prob > f->probs[i]) f->periods[i] = period;
+      f->probs[i] += prob;
+      return;
+    }
+  }
+  if (f->count == PYIN_MAX_CANDIDATES) {
+    f->voiced -= prob;
+    return;
+  }
+  f->bins[f->count] = b;
+  f->periods[f->count] = period;
+  f->probs[f->count] = prob;
+  f->count++;
+}
+
+void
+aubio_pitchpyin_get_candidates (aubio_pitchpyin_t * o, const fvec_t * yin,
+    aubio_pitchpyin_frame_t * f)
+{
+  // above every threshold
+  smpl_t record = 1., prob;
+  uint_t tau, deepest = 0;
+  f->count = 0;
+  f->voiced = 0.;
+  // the first dip below a threshold is the first local minimum deeper than
+  // it, so each minimum deeper than all the previous ones gets the mass of the
+  // thresholds between its depth and the depth of the previous such minimum
+  for (tau = 2; tau + 1 < yin->length; tau++) {
+    if (!(yin->data[tau] < yin->data[tau - 1]
+          && yin->data[tau] <= yin->data[tau + 1])) continue;
+    if (yin->data[tau] >= record) continue;
+    prob = aubio_pitchpyin_cumprior (o, record)
+      - aubio_pitchpyin_cumprior (o, yin->data[tau]);
+    record = yin->data[tau];
+    deepest = tau;
+    if (prob > 0.) {
+      aubio_pitchpyin_add_candidate (o, f, yin, tau, prob);
+    }
+  }
+  // thresholds below every dip select the global minimum, with a low prior
+  if (deepest > 0) {
+    prob = PYIN_ABSMIN_PRIOR * aubio_pitchpyin_cumprior (o, record);
+    if (prob > 0.) {
+      aubio_pitchpyin_add_candidate (o, f, yin, deepest, prob);
+    }
+  }
+}
+
+/* min heap of states, the least likely one on top */
+static void
+aubio_pitchpyin_heap_down (uint_t * heap, uint_t n, uint_t i, const smpl_t * v)
+{
+  uint_t c, tmp;
+  while ((c = 2 * i + 1) < n) {
+    if (c + 1 < n && v[heap[c + 1]] < v[heap[c]]) c++;
+    if (v[heap[i]] <= v[heap[c]]) break;
+    tmp = heap[i];
+    heap[i] = heap[c];
+    heap[c] = tmp;
+    i = c;
+  }
+}
+
+static void
+aubio_pitchpyin_heap_up (uint_t * heap, uint_t i, const smpl_t * v)
+{
+  uint_t p, tmp;
+  while (i > 0 && v[heap[p = (i - 1) / 2]] > v[heap[i]]) {
+    tmp = heap[i];
+    heap[i] = heap[p];
+    heap[p] = tmp;
+    i = p;
+  }
+}
+
+/* keep a transition to state t if it is the most likely one so far */
+#define PYIN_UPDATE(t, p, s) \
+  if ((p) > next[t]) { \
+    if (next[t] == 0.) o->touched[o->ntouched++] = (t); \
+    next[t] = (p); \
+    bp[t] = (s); \
+  }
+
+void
+aubio_pitchpyin_decode (aubio_pitchpyin_t * o, fvec_t * out)
+{
+  aubio_pitchpyin_frame_t *f = &o->frames[o->pos];
+  uint_t *bp = o->bp + o->pos * PYIN_STATES;
+  smpl_t *next = o->next;
+  smpl_t unvoiced = (1. - PYIN_YIN_TRUST * f->voiced) / PYIN_BINS;
+  smpl_t d, p, w, to_voiced, to_unvoiced, best = 0., reentry = 0.;
+  uint_t i, s, t, b, lo, hi, beststate = PYIN_BINS, reentrystate = PYIN_BINS, slot;
+
+  for (i = 0; i < f->count; i++) {
+    o->obs[f->bins[i]] += PYIN_YIN_TRUST * f->probs[i];
+  }
+
+  o->ntouched = 0;
+  o->transitions = 0;
+  if (o->nactive == 0) {
+    // first frame, uniform initial distribution
+    for (s = 0; s < PYIN_STATES; s++) {
+      PYIN_UPDATE(s, 1., s);
+    }
+  } else {
+    // only transitions from active states, within the band, to voiced states
+    // with candidates, or to unvoiced states
+    for (i = 0; i < o->nactive; i++) {
+      s = o->active[i];
+      d = o->delta[i];
+      b = s < PYIN_BINS ? s : s - PYIN_BINS;
+      lo = b > PYIN_BAND ? b - PYIN_BAND : 0;
+      hi = MIN(b + PYIN_BAND, PYIN_BINS - 1);
+      to_voiced = d * (s < PYIN_BINS ? PYIN_VOICING_STAY : 1. - PYIN_VOICING_STAY);
+      to_unvoiced = d * (s < PYIN_BINS ? 1. - PYIN_VOICING_STAY : PYIN_VOICING_STAY);
+      for (t = lo; t <= hi; t++) {
+        w = o->trans[t > b ? t - b : b - t];
+        if (o->obs[t] > 0.) {
+          p = to_voiced * w;
+          PYIN_UPDATE(t, p, s);
+        }
+        p = to_unvoiced * w;
+        PYIN_UPDATE(PYIN_BINS + t, p, s);
+      }
+      o->transitions += (hi - lo + 1) * 2;
+      if (s >= PYIN_BINS && d > reentry) {
+        reentry = d;
+        reentrystate = s;
+      }
+    }
+    // unvoiced states far from the candidates were pruned, but after a few
+    // unvoiced frames they are about as likely as the best unvoiced state, so
+    // it stands for the unvoiced state of each candidate bin
+    if (reentry > 0.) {
+      p = reentry * (1. - PYIN_VOICING_STAY) * o->trans[0];
+      for (i = 0; i < f->count; i++) {
+        t = f->bins[i];
+        PYIN_UPDATE(t, p, reentrystate);
+      }
+      o->transitions += f->count;
+    }
+  }
+
+  // apply observations and keep the most likely states
+  o->nactive = 0;
+  for (i = 0; i < o->ntouched; i++) {
+    s = o->touched[i];
+    next[s] *= s < PYIN_BINS ? o->obs[s] : unvoiced;
+    if (next[s] <= 0.) continue;
+    if (o->nactive < o->beam) {
+      o->active[o->nactive] = s;
+      aubio_pitchpyin_heap_up (o->active, o->nactive++, next);
+    } else if (next[s] > next[o->active[0]]) {
+      o->active[0] = s;
+      aubio_pitchpyin_heap_down (o->active, o->nactive, 0, next);
+    }
+  }
+  for (i = 0; i < o->nactive; i++) {
+    if (next[o->active[i]] > best) {
+      best = next[o->active[i]];
+      beststate = o->active[i];
+    }
+  }
+  // normalise, so that the most likely state has probability 1
+  for (i = 0; i < o->nactive; i++) {
+    o->delta[i] = next[o->active[i]] / best;
+  }
+  for (i = 0; i < o->ntouched; i++) {
+    next[o->touched[i]] = 0.;
+  }
+  for (i = 0; i < f->count; i++) {
+    o->obs[f->bins[i]] = 0.;
+  }
+
+  if (o->count < o->lag) {
+    // not enough frames to decide yet
+    o->count++;
+    o->confidence = 0.;
+    out->data[0] = 0.;
+  } else {
+    // trace the most likely path back to the frame to decide on
+    s = beststate;
+    slot = o->pos;
+    for (i = 0; i < o->lag; i++) {
+      s = o->bp[slot * PYIN_STATES + s];
+      slot = slot > 0 ? slot - 1 : AUBIO_PITCHPYIN_MAX_LAG;
+    }
+    f = &o->frames[slot];
+    o->confidence = f->voiced;
+    out->data[0] = 0.;
+    if (s < PYIN_BINS) {
+      for (i = 0; i < f->count; i++) {
+        if (f->bins[i] == s) out->data[0] = f->periods[i];
+      }
+    }
+  }
+  o->pos = o->pos < AUBIO_PITCHPYIN_MAX_LAG ? o->pos + 1 : 0;
+}
+
+uint_t
+aubio_pitchpyin_set_tolerance (aubio_pitchpyin_t * o, smpl_t tol)
+{
+  smpl_t a, b, x, sum = 0.;
+  uint_t i;
+  if (tol < 0.01 || tol > 0.5) {
+    AUBIO_ERR ("pitchpyin: tolerance should be between 0.01 and 0.5, got %f\n", tol);
+    return AUBIO_FAIL;
+  }
+  // Beta distribution with the given mean, alpha + beta = 20 as in the
+  // original method
+  a = 20. * tol;
+  b = 20. * (1. - tol);
+  o->cumprior[0] = 0.;
+  for (i = 1; i <= PYIN_THRESHOLDS; i++) {
+    x = (smpl_t)i / PYIN_THRESHOLDS;
+    sum += POW(x, a - 1.) * POW(1. - x, b - 1.);
+    o->cumprior[i] = sum;
+  }
+  for (i = 1; i <= PYIN_THRESHOLDS; i++) {
+    o->cumprior[i] /= sum;
+  }
+  o->tol = tol;
+  return AUBIO_OK;
+}
+
+smpl_t
+aubio_pitchpyin_get_tolerance (aubio_pitchpyin_t * o)
+{
+  return o->tol;
+}
+
+smpl_t
+aubio_pitchpyin_get_confidence (aubio_pitchpyin_t * o)
+{
+  return o->confidence;
+}
+
+uint_t
+aubio_pitchpyin_set_lag (aubio_pitchpyin_t * o, uint_t lag)
+{
+  if (lag > AUBIO_PITCHPYIN_MAX_LAG) {
+    AUBIO_ERR ("pitchpyin: lag should be at most %d, got %d\n",
+        AUBIO_PITCHPYIN_MAX_LAG, lag);
+    return AUBIO_FAIL;
+  }
+  o->lag = lag;
+  o->count = MIN(o->count, lag);
+  return AUBIO_OK;
+}
+
+uint_t
+aubio_pitchpyin_get_lag (aubio_pitchpyin_t * o)
+{
+  return o->lag;
+}
+
+uint_t
+aubio_pitchpyin_set_beam (aubio_pitchpyin_t * o, uint_t beam)
+{
+  if (beam < 1 || beam > PYIN_STATES) {
+    AUBIO_ERR ("pitchpyin: beam should be between 1 and %d, got %d\n",
+        PYIN_STATES, beam);
+    return AUBIO_FAIL;
+  }
+  o->beam = beam;
+  // keep the current states, the beam applies from the next frame
+  return AUBIO_OK;
+}
+
+uint_t
+aubio_pitchpyin_get_beam (aubio_pitchpyin_t * o)
+{
+  return o->beam;
+}
+
+uint_t
+aubio_pitchpyin_get_transitions (aubio_pitchpyin_t * o)
+{
+  return o->transitions;
+}
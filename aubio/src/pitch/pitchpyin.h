@@ -0,0 +1,199 @@
+/*
+  Copyright (C) 2022 Filipe Coelho <falktx@falktx.com>
+
+  This file is part of aubio.
+
+  aubio is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  aubio is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with aubio.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+/** \file
+
+  Pitch detection using probabilistic YIN, decoded in real time
+
+  This algorithm was developed by M. Mauch and S. Dixon and published in:
+
+  Mauch, M., Dixon, S. (2014) "pYIN: A fundamental frequency estimator using
+  probabilistic threshold distributions", Proceedings of the IEEE
+  International Conference on Acoustics, Speech, and Signal Processing
+  (ICASSP 2014).
+
+  The YIN function is computed as in ::aubio_pitchyinfast_t. Instead of a
+  single tolerance, a distribution of 100 thresholds is applied to it, giving
+  a few period candidates with their probabilities. All thresholds are
+  evaluated in one scan of the function: each local minimum deeper than all
+  the previous ones gets the mass of the thresholds it is the first to pass.
+
+  Candidates are then tracked with a hidden Markov model of 5 pitch bins per
+  semitone, each voiced or unvoiced, favouring small pitch changes and few
+  voicing changes. Unlike the original offline method, the model is decoded
+  as the signal comes in:
+
+  - Viterbi decoding only keeps the most likely states of each frame (the
+    beam), and transitions are limited to a band of 5 semitones around each
+    state, so that the cost of a frame is bounded by the beam size. Since
+    unvoiced states far from the kept ones are pruned, the most likely
+    unvoiced state can also move to any candidate, standing for the unvoiced
+    state of the candidate bin.
+  - The path is traced back over a fixed number of frames (the lag) to decide
+    on the pitch of the frame that many frames in the past. A longer lag gives
+    smoother decisions, at the cost of latency.
+
+*/
+
+#ifndef AUBIO_PITCHPYIN_H
+#define AUBIO_PITCHPYIN_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** maximum number of frames the decision can be delayed by */
+#define AUBIO_PITCHPYIN_MAX_LAG 32
+
+/** pitch detection object */
+typedef struct _aubio_pitchpyin_t aubio_pitchpyin_t;
+
+/** creation of the pitch detection object
+
+  \param samplerate samplerate of the input signal
+  \param buf_size size of the input buffer to analyse
+
+*/
+aubio_pitchpyin_t *new_aubio_pitchpyin (uint_t samplerate, uint_t buf_size);
+
+/** deletion of the pitch detection object
+
+  \param o pitch detection object as returned by new_aubio_pitchpyin()
+
+*/
+void del_aubio_pitchpyin (aubio_pitchpyin_t * o);
+
+/** execute pitch detection on an input buffer
+
+  \param o pitch detection object as returned by new_aubio_pitchpyin()
+  \param samples_in input signal vector (length as specified at creation time)
+  \param cands_out decoded period of the frame `lag` frames ago, in samples,
+  or 0 if that frame was unvoiced
+
+*/
+void aubio_pitchpyin_do (aubio_pitchpyin_t * o, const fvec_t * samples_in,
+    fvec_t * cands_out);
+
+/** advance the decoder with a frame known to be unvoiced
+
+  \param o pitch detection object as returned by new_aubio_pitchpyin()
+  \param cands_out decoded period of the frame `lag` frames ago, in samples,
+  or 0 if that frame was unvoiced
+
+  Same as aubio_pitchpyin_do(), without analysing the frame, for instance
+  when it is below the silence threshold.
+
+*/
+void aubio_pitchpyin_do_unvoiced (aubio_pitchpyin_t * o, fvec_t * cands_out);
+
+/** set the mean of the threshold distribution
+
+  \param o pitch detection object as returned by new_aubio_pitchpyin()
+  \param tol mean threshold, between 0.01 and 0.5 [default 0.15]
+
+  Thresholds follow a Beta distribution with this mean, as in the original
+  method, which uses 0.1, 0.15 or 0.2.
+
+  \return 0 if successful, non-zero otherwise
+
+*/
+uint_t aubio_pitchpyin_set_tolerance (aubio_pitchpyin_t * o, smpl_t tol);
+
+/** get the mean of the threshold distribution
+
+  \param o pitch detection object as returned by new_aubio_pitchpyin()
+
+  \return mean threshold
+
+*/
+smpl_t aubio_pitchpyin_get_tolerance (aubio_pitchpyin_t * o);
+
+/** get the confidence of the last decision
+
+  \param o pitch detection object as returned by new_aubio_pitchpyin()
+
+  \return probability that the decided frame is voiced, according to its
+  period candidates
+
+*/
+smpl_t aubio_pitchpyin_get_confidence (aubio_pitchpyin_t * o);
+
+/** set the number of frames decisions are delayed by
+
+  \param o pitch detection object as returned by new_aubio_pitchpyin()
+  \param lag number of frames, up to ::AUBIO_PITCHPYIN_MAX_LAG [default 4]
+
+  \return 0 if successful, non-zero otherwise
+
+*/
+uint_t aubio_pitchpyin_set_lag (aubio_pitchpyin_t * o, uint_t lag);
+
+/** get the number of frames decisions are delayed by
+
+  \param o pitch detection object as returned by new_aubio_pitchpyin()
+
+  \return number of frames
+
+*/
+uint_t aubio_pitchpyin_get_lag (aubio_pitchpyin_t * o);
+
+/** set the maximum number of states kept from one frame to the next
+
+  \param o pitch detection object as returned by new_aubio_pitchpyin()
+  \param beam number of states, at least 1 [default 48]
+
+  The decoding cost of a frame is at most `beam` times 102 transitions, plus
+  one per period candidate.
+
+  \return 0 if successful, non-zero otherwise
+
+*/
+uint_t aubio_pitchpyin_set_beam (aubio_pitchpyin_t * o, uint_t beam);
+
+/** get the maximum number of states kept from one frame to the next
+
+  \param o pitch detection object as returned by new_aubio_pitchpyin()
+
+  \return number of states
+
+*/
+uint_t aubio_pitchpyin_get_beam (aubio_pitchpyin_t * o);
+
+/** get the number of transitions evaluated for the last frame
+
+  \param o pitch detection object as returned by new_aubio_pitchpyin()
+
+  \return number of transitions, a measure of the decoding cost of the frame
+
+*/
+uint_t aubio_pitchpyin_get_transitions (aubio_pitchpyin_t * o);
+
+/** reset the decoder, forgetting all previous frames
+
+  \param o pitch detection object as returned by new_aubio_pitchpyin()
+
+*/
+void aubio_pitchpyin_reset (aubio_pitchpyin_t * o);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AUBIO_PITCHPYIN_H */
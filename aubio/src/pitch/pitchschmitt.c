@@ -110,6 +110,16 @@ aubio_schmittS16LE (aubio_pitchschmitt_t * p, uint_t nframes,
   return period;
 }
 
+void
+aubio_pitchschmitt_reset (aubio_pitchschmitt_t * p)
+{
+  uint_t j;
+  for (j = 0; j < p->blockSize; j++) {
+    p->schmittBuffer[j] = 0;
+  }
+  p->schmittPointer = p->schmittBuffer;
+}
+
 void
 del_aubio_pitchschmitt (aubio_pitchschmitt_t * p)
 {
@@ -68,6 +68,14 @@ aubio_pitchschmitt_t *new_aubio_pitchschmitt (uint_t buf_size);
 */
 void del_aubio_pitchschmitt (aubio_pitchschmitt_t * p);
 
+/** reset the pitch detection object, dropping the samples of the unfinished
+  block
+
+  \param p pitch detection object as returned by new_aubio_pitchschmitt
+
+*/
+void aubio_pitchschmitt_reset (aubio_pitchschmitt_t * p);
+
 #ifdef __cplusplus
 }
 #endif
@@ -37,6 +37,7 @@ struct _aubio_pitchyin_t
   fvec_t *yin;
   smpl_t tol;
   uint_t peak_pos;
+  uint_t end;         /**< number of computed values of yin */
 };
 
 #if 0
@@ -70,6 +71,7 @@ new_aubio_pitchyin (uint_t bufsize)
   o->yin = new_fvec (bufsize / 2);
   o->tol = 0.15;
   o->peak_pos = 0;
+  o->end = 0;
   return o;
 }
 
@@ -162,10 +164,12 @@ aubio_pitchyin_do (aubio_pitchyin_t * o, const fvec_t * input, fvec_t * out)
     if (tau > 4 && (yin_data[period] < tol) &&
         (yin_data[period] < yin_data[period + 1])) {
       o->peak_pos = (uint_t)period;
+      o->end = tau + 1;
       out->data[0] = fvec_quadratic_peak_pos (yin, o->peak_pos);
       return;
     }
   }
+  o->end = length;
   o->peak_pos = (uint_t)fvec_min_elem (yin);
   out->data[0] = fvec_quadratic_peak_pos (yin, o->peak_pos);
 }
@@ -175,6 +179,17 @@ aubio_pitchyin_get_confidence (aubio_pitchyin_t * o) {
   return 1. - o->yin->data[o->peak_pos];
 }
 
+uint_t
+aubio_pitchyin_get_candidates (aubio_pitchyin_t * o, fvec_t * periods,
+    fvec_t * confidences)
+{
+  uint_t i, count = fvec_min_peaks (o->yin, o->end, periods, confidences);
+  for (i = 0; i < count; i++) {
+    confidences->data[i] = 1. - confidences->data[i];
+  }
+  return count;
+}
+
 uint_t
 aubio_pitchyin_set_tolerance (aubio_pitchyin_t * o, smpl_t tol)
 {
@@ -93,6 +93,21 @@ smpl_t aubio_pitchyin_get_tolerance (aubio_pitchyin_t * o);
 */
 smpl_t aubio_pitchyin_get_confidence (aubio_pitchyin_t * o);
 
+/** get the deepest minima of the YIN function of the last frame
+
+  \param o YIN pitch detection object
+  \param periods output period candidates, in samples, sorted by decreasing
+  confidence, as many as the length of this vector
+  \param confidences output confidence of each candidate, same length
+
+  The YIN function is only computed up to the first period below the
+  tolerance, candidates are searched for in that range only.
+
+  \return number of candidates found
+
+*/
+uint_t aubio_pitchyin_get_candidates (aubio_pitchyin_t * o, fvec_t * periods, fvec_t * confidences);
+
 #ifdef __cplusplus
 }
 #endif
@@ -45,6 +45,8 @@ struct _aubio_pitchyinfast_t
   fvec_t *samples_fft;
   fvec_t *kernel_fft;
   aubio_fft_t *fft;
+  uint_t end;         /**< number of normalised values of yin */
+  smpl_t cumsum;      /**< sum of the difference function up to end */
 };
 
 aubio_pitchyinfast_t *
@@ -66,6 +68,8 @@ new_aubio_pitchyinfast (uint_t bufsize)
   }
   o->tol = 0.15;
   o->peak_pos = 0;
+  o->end = 0;
+  o->cumsum = 0.;
   return o;
 }
 
@@ -92,6 +96,14 @@ del_aubio_pitchyinfast (aubio_pitchyinfast_t * o)
 /* all the above in one */
 void
 aubio_pitchyinfast_do (aubio_pitchyinfast_t * o, const fvec_t * input, fvec_t * out)
+{
+  aubio_fft_do_complex(o->fft, input, o->samples_fft);
+  aubio_pitchyinfast_do_complex(o, input, o->samples_fft, out);
+}
+
+void
+aubio_pitchyinfast_do_complex (aubio_pitchyinfast_t * o, const fvec_t * input,
+    const fvec_t * samples_fft, fvec_t * out)
 {
   const smpl_t tol = o->tol;
   fvec_t* yin = o->yin;
@@ -129,7 +141,6 @@ aubio_pitchyinfast_do (aubio_pitchyinfast_t * o, const fvec_t * input, fvec_t *
   {
     fvec_t *compmul = o->tmpdata;
     fvec_t *rt_of_tau = o->samples_fft;
-    aubio_fft_do_complex(o->fft, input, o->samples_fft);
     // build kernel, take a copy of first half of samples
     tmp_slice.data = input->data;
     tmp_slice.length = W;
@@ -141,15 +152,15 @@ aubio_pitchyinfast_do (aubio_pitchyinfast_t * o, const fvec_t * input, fvec_t *
     // compute fft(kernel)
     aubio_fft_do_complex(o->fft, o->kernel, o->kernel_fft);
     // compute complex product
-    compmul->data[0]  = o->kernel_fft->data[0] * o->samples_fft->data[0];
+    compmul->data[0]  = o->kernel_fft->data[0] * samples_fft->data[0];
     for (tau = 1; tau < W; tau++) {
-      compmul->data[tau]    = o->kernel_fft->data[tau] * o->samples_fft->data[tau];
-      compmul->data[tau]   -= o->kernel_fft->data[B-tau] * o->samples_fft->data[B-tau];
+      compmul->data[tau]    = o->kernel_fft->data[tau] * samples_fft->data[tau];
+      compmul->data[tau]   -= o->kernel_fft->data[B-tau] * samples_fft->data[B-tau];
     }
-    compmul->data[W]    = o->kernel_fft->data[W] * o->samples_fft->data[W];
+    compmul->data[W]    = o->kernel_fft->data[W] * samples_fft->data[W];
     for (tau = 1; tau < W; tau++) {
-      compmul->data[B-tau]  = o->kernel_fft->data[B-tau] * o->samples_fft->data[tau];
-      compmul->data[B-tau] += o->kernel_fft->data[tau] * o->samples_fft->data[B-tau];
+      compmul->data[B-tau]  = o->kernel_fft->data[B-tau] * samples_fft->data[tau];
+      compmul->data[B-tau] += o->kernel_fft->data[tau] * samples_fft->data[B-tau];
     }
     // compute inverse fft
     aubio_fft_rdo_complex(o->fft, compmul, rt_of_tau);
@@ -173,10 +184,13 @@ aubio_pitchyinfast_do (aubio_pitchyinfast_t * o, const fvec_t * input, fvec_t *
     if (tau > 4 && (yin->data[period] < tol) &&
         (yin->data[period] < yin->data[period + 1])) {
       o->peak_pos = (uint_t)period;
+      o->end = tau + 1;
+      o->cumsum = tmp2;
       out->data[0] = fvec_quadratic_peak_pos (yin, o->peak_pos);
       return;
     }
   }
+  o->end = length;
   // use global minimum 
   o->peak_pos = (uint_t)fvec_min_elem (yin);
   out->data[0] = fvec_quadratic_peak_pos (yin, o->peak_pos);
@@ -187,6 +201,37 @@ aubio_pitchyinfast_get_confidence (aubio_pitchyinfast_t * o) {
   return 1. - o->yin->data[o->peak_pos];
 }
 
+const fvec_t *
+aubio_pitchyinfast_get_yin (aubio_pitchyinfast_t * o)
+{
+  fvec_t *yin = o->yin;
+  uint_t tau;
+  // the search stopped at the first dip, normalise the rest of the function
+  for (tau = o->end; tau < yin->length; tau++) {
+    o->cumsum += yin->data[tau];
+    if (o->cumsum != 0) {
+      yin->data[tau] *= tau / o->cumsum;
+    } else {
+      yin->data[tau] = 1.;
+    }
+  }
+  o->end = yin->length;
+  return yin;
+}
+
+uint_t
+aubio_pitchyinfast_get_candidates (aubio_pitchyinfast_t * o, fvec_t * periods,
+    fvec_t * confidences)
+{
+  const fvec_t *yin = aubio_pitchyinfast_get_yin (o);
+  uint_t i, count;
+  count = fvec_min_peaks (yin, yin->length, periods, confidences);
+  for (i = 0; i < count; i++) {
+    confidences->data[i] = 1. - confidences->data[i];
+  }
+  return count;
+}
+
 uint_t
 aubio_pitchyinfast_set_tolerance (aubio_pitchyinfast_t * o, smpl_t tol)
 {
@@ -69,6 +69,21 @@ void del_aubio_pitchyinfast (aubio_pitchyinfast_t * o);
 */
 void aubio_pitchyinfast_do (aubio_pitchyinfast_t * o, const fvec_t * samples_in, fvec_t * cands_out);
 
+/** execute pitch detection on an input buffer and its Fourier transform
+
+  \param o pitch detection object as returned by new_aubio_pitchyin()
+  \param samples_in input signal vector (length as specified at creation time)
+  \param samples_fft complex spectrum of `samples_in`, as computed by
+  aubio_fft_do_complex() without any window
+  \param cands_out pitch period candidates, in samples
+
+  Same as aubio_pitchyinfast_do(), for callers sharing the transform of the
+  input with other analysers.
+
+*/
+void aubio_pitchyinfast_do_complex (aubio_pitchyinfast_t * o, const fvec_t * samples_in,
+    const fvec_t * samples_fft, fvec_t * cands_out);
+
 
 /** set tolerance parameter for YIN algorithm
 
@@ -94,6 +109,33 @@ smpl_t aubio_pitchyinfast_get_tolerance (aubio_pitchyinfast_t * o);
 */
 smpl_t aubio_pitchyinfast_get_confidence (aubio_pitchyinfast_t * o);
 
+/** get the deepest minima of the YIN function of the last frame
+
+  \param o YIN pitch detection object
+  \param periods output period candidates, in samples, sorted by decreasing
+  confidence, as many as the length of this vector
+  \param confidences output confidence of each candidate, same length
+
+  Normalisation of the YIN function stops after the first period below the
+  tolerance, it is completed by this function if needed.
+
+  \return number of candidates found
+
+*/
+uint_t aubio_pitchyinfast_get_candidates (aubio_pitchyinfast_t * o, fvec_t * periods, fvec_t * confidences);
+
+/** get the YIN function of the last frame
+
+  \param o YIN pitch detection object
+
+  Normalisation of the YIN function stops after the first period below the
+  tolerance, it is completed by this function if needed.
+
+  \return cumulative mean normalized difference function, [buf_size / 2]
+
+*/
+const fvec_t * aubio_pitchyinfast_get_yin (aubio_pitchyinfast_t * o);
+
 #ifdef __cplusplus
 }
 #endif
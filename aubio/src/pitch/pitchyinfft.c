@@ -107,15 +107,15 @@ beach:
   return NULL;
 }
 
+/* find the period from the weighted squared magnitude spectrum in sqrmag */
+static void aubio_pitchyinfft_do_sqrmag (aubio_pitchyinfft_t * p, fvec_t * output);
+
 void
 aubio_pitchyinfft_do (aubio_pitchyinfft_t * p, const fvec_t * input, fvec_t * output)
 {
-  uint_t tau, l;
+  uint_t l;
   uint_t length = p->fftout->length;
-  uint_t halfperiod;
   fvec_t *fftout = p->fftout;
-  fvec_t *yin = p->yinfft;
-  smpl_t tmp = 0., sum = 0.;
   // window the input
   fvec_weighted_copy(input, p->win, p->winput);
   // get the real / imag parts of its fft
@@ -130,6 +130,88 @@ aubio_pitchyinfft_do (aubio_pitchyinfft_t * p, const fvec_t * input, fvec_t * ou
   }
   p->sqrmag->data[length / 2] = SQR(fftout->data[length / 2]);
   p->sqrmag->data[length / 2] *= p->weight->data[length / 2];
+  aubio_pitchyinfft_do_sqrmag (p, output);
+}
+
+void
+aubio_pitchyinfft_do_spectrum (aubio_pitchyinfft_t * p, const cvec_t * spectrum,
+    fvec_t * output)
+{
+  uint_t l;
+  uint_t length = p->fftout->length;
+  // the norm of the spectrum is the magnitude of the complex fft above
+  p->sqrmag->data[0] = SQR(spectrum->norm[0]) * p->weight->data[0];
+  for (l = 1; l < length / 2; l++) {
+    p->sqrmag->data[l] = SQR(spectrum->norm[l]) * p->weight->data[l];
+    p->sqrmag->data[length - l] = p->sqrmag->data[l];
+  }
+  p->sqrmag->data[length / 2] = SQR(spectrum->norm[length / 2])
+    * p->weight->data[length / 2];
+  aubio_pitchyinfft_do_sqrmag (p, output);
+}
+
+/* get bin k of a real signal spectrum in aubio_fft_do_complex() layout,
+   for -1 <= k <= length / 2 + 1 */
+static void
+aubio_pitchyinfft_get_bin (const fvec_t * compspec, sint_t k, smpl_t * re, smpl_t * im)
+{
+  sint_t length = compspec->length;
+  smpl_t sign = 1.;
+  // spectra of real signals are symmetric, X[-k] = X[N-k] = conj(X[k])
+  if (k < 0) {
+    k = -k;
+    sign = -1.;
+  } else if (k > length / 2) {
+    k = length - k;
+    sign = -1.;
+  }
+  *re = compspec->data[k];
+  *im = (k > 0 && k < length / 2) ? sign * compspec->data[length - k] : 0.;
+}
+
+void
+aubio_pitchyinfft_do_complex (aubio_pitchyinfft_t * p, const fvec_t * compspec,
+    fvec_t * output)
+{
+  uint_t l;
+  uint_t length = p->fftout->length;
+  smpl_t re, im, prev_re, prev_im, next_re, next_im;
+  if (compspec->length != length) {
+    AUBIO_ERR ("pitchyinfft: got spectrum of size %d, expected %d\n",
+        compspec->length, length);
+    output->data[0] = 0.;
+    p->peak_pos = 0;
+    return;
+  }
+  // window w[n] = .5 - .25 exp(2i pi n/N) - .25 exp(-2i pi n/N), so that the
+  // windowed spectrum is .5 X[k] - .25 X[k-1] - .25 X[k+1]
+  aubio_pitchyinfft_get_bin (compspec, -1, &prev_re, &prev_im);
+  aubio_pitchyinfft_get_bin (compspec, 0, &re, &im);
+  for (l = 0; l < length / 2 + 1; l++) {
+    aubio_pitchyinfft_get_bin (compspec, l + 1, &next_re, &next_im);
+    p->sqrmag->data[l] = SQR(.5 * re - .25 * (prev_re + next_re))
+      + SQR(.5 * im - .25 * (prev_im + next_im));
+    p->sqrmag->data[l] *= p->weight->data[l];
+    if (l > 0 && l < length / 2) {
+      p->sqrmag->data[length - l] = p->sqrmag->data[l];
+    }
+    prev_re = re;
+    prev_im = im;
+    re = next_re;
+    im = next_im;
+  }
+  aubio_pitchyinfft_do_sqrmag (p, output);
+}
+
+static void
+aubio_pitchyinfft_do_sqrmag (aubio_pitchyinfft_t * p, fvec_t * output)
+{
+  uint_t tau, l;
+  uint_t length = p->fftout->length;
+  uint_t halfperiod;
+  fvec_t *fftout = p->fftout;
+  fvec_t *yin = p->yinfft;
+  smpl_t tmp = 0., sum = 0.;
   // get sum of weighted squared mags
   for (l = 0; l < length / 2 + 1; l++) {
     sum += p->sqrmag->data[l];
@@ -160,6 +242,7 @@ aubio_pitchyinfft_do (aubio_pitchyinfft_t * p, const fvec_t * input, fvec_t * ou
     //return fvec_quadratic_peak_pos (yin,tau,1);
     /* additional check for (unlikely) octave doubling in higher frequencies */
     if (tau > p->short_period) {
+      p->peak_pos = tau;
       output->data[0] = fvec_quadratic_peak_pos (yin, tau);
     } else {
       /* should compare the minimum value of each interpolated peaks */
@@ -194,6 +277,18 @@ aubio_pitchyinfft_get_confidence (aubio_pitchyinfft_t * o) {
   return 1. - o->yinfft->data[o->peak_pos];
 }
 
+uint_t
+aubio_pitchyinfft_get_candidates (aubio_pitchyinfft_t * o, fvec_t * periods,
+    fvec_t * confidences)
+{
+  uint_t i, count = fvec_min_peaks (o->yinfft, o->yinfft->length, periods,
+      confidences);
+  for (i = 0; i < count; i++) {
+    confidences->data[i] = 1. - confidences->data[i];
+  }
+  return count;
+}
+
 uint_t
 aubio_pitchyinfft_set_tolerance (aubio_pitchyinfft_t * p, smpl_t tol)
 {
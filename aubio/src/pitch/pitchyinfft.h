@@ -53,6 +53,33 @@ typedef struct _aubio_pitchyinfft_t aubio_pitchyinfft_t;
 
 */
 void aubio_pitchyinfft_do (aubio_pitchyinfft_t * o, const fvec_t * samples_in, fvec_t * cands_out);
+/** execute pitch detection on a spectral frame
+
+  \param o pitch detection object as returned by new_aubio_pitchyinfft
+  \param spectrum spectral frame of the input signal, as computed by
+  aubio_pvoc_do() with a window of the size given at creation time
+  \param cands_out pitch period candidates, in samples
+
+  Same as aubio_pitchyinfft_do(), for an input signal already transformed,
+  for instance by a shared ::aubio_frontend_t.
+
+*/
+void aubio_pitchyinfft_do_spectrum (aubio_pitchyinfft_t * o, const cvec_t * spectrum, fvec_t * cands_out);
+
+/** execute pitch detection on the Fourier transform of an input buffer
+
+  \param o pitch detection object as returned by new_aubio_pitchyinfft
+  \param compspec complex spectrum of the input signal, as computed by
+  aubio_fft_do_complex() without any window
+  \param cands_out pitch period candidates, in samples
+
+  The HanningZ window is applied in the spectral domain, by combining each bin
+  with its two neighbours, so that the same transform can be shared with
+  methods working on the unwindowed signal, such as
+  aubio_pitchyinfast_do_complex().
+
+*/
+void aubio_pitchyinfft_do_complex (aubio_pitchyinfft_t * o, const fvec_t * compspec, fvec_t * cands_out);
 /** creation of the pitch detection object
 
   \param samplerate samplerate of the input signal
@@ -92,6 +119,18 @@ uint_t aubio_pitchyinfft_set_tolerance (aubio_pitchyinfft_t * o, smpl_t tol);
 */
 smpl_t aubio_pitchyinfft_get_confidence (aubio_pitchyinfft_t * o);
 
+/** get the deepest minima of the YIN function of the last frame
+
+  \param o YIN pitch detection object
+  \param periods output period candidates, in samples, sorted by decreasing
+  confidence, as many as the length of this vector
+  \param confidences output confidence of each candidate, same length
+
+  \return number of candidates found
+
+*/
+uint_t aubio_pitchyinfft_get_candidates (aubio_pitchyinfft_t * o, fvec_t * periods, fvec_t * confidences);
+
 #ifdef __cplusplus
 }
 #endif
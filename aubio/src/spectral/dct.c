@@ -65,12 +65,12 @@ extern void aubio_dct_ooura_rdo(aubio_dct_ooura_t *s, const fvec_t *input, fvec_
 extern void del_aubio_dct_ooura (aubio_dct_ooura_t *s);
 #endif
 
-// plain mode
-typedef struct _aubio_dct_plain_t aubio_dct_plain_t;
-extern aubio_dct_plain_t * new_aubio_dct_plain (uint_t size);
-extern void aubio_dct_plain_do(aubio_dct_plain_t *s, const fvec_t *input, fvec_t *output);
-extern void aubio_dct_plain_rdo(aubio_dct_plain_t *s, const fvec_t *input, fvec_t *output);
-extern void del_aubio_dct_plain (aubio_dct_plain_t *s);
+// any size, using the fft backend
+typedef struct _aubio_dct_fft_t aubio_dct_fft_t;
+extern aubio_dct_fft_t * new_aubio_dct_fft (uint_t size);
+extern void aubio_dct_fft_do(aubio_dct_fft_t *s, const fvec_t *input, fvec_t *output);
+extern void aubio_dct_fft_rdo(aubio_dct_fft_t *s, const fvec_t *input, fvec_t *output);
+extern void del_aubio_dct_fft (aubio_dct_fft_t *s);
 
 struct _aubio_dct_t {
   void *dct;
@@ -92,7 +92,7 @@ aubio_dct_t* new_aubio_dct (uint_t size) {
       order++;
     }
     if (order < 4 || (radix != 1 && radix != 3 && radix != 5 && radix != 15)) {
-      goto plain;
+      goto generic;
     }
   }
   s->dct = (void *)new_aubio_dct_accelerate (size);
@@ -113,7 +113,7 @@ aubio_dct_t* new_aubio_dct (uint_t size) {
   } else {
     AUBIO_WRN("dct: unexpected error while creating dct_fftw with size %d\n",
         size);
-    goto plain;
+    goto generic;
   }
 #elif defined(HAVE_INTEL_IPP)
   // unclear from the docs, but intel ipp seems to support any size
@@ -126,12 +126,12 @@ aubio_dct_t* new_aubio_dct (uint_t size) {
   } else {
     AUBIO_WRN("dct: unexpected error while creating dct_ipp with size %d\n",
         size);
-    goto plain;
+    goto generic;
   }
 #else
   // ooura support sizes that are power of 2
   if (aubio_is_power_of_two(size) != 1 || size == 1) {
-    goto plain;
+    goto generic;
   }
   s->dct = (void *)new_aubio_dct_ooura (size);
   if (s->dct) {
@@ -141,15 +141,15 @@ aubio_dct_t* new_aubio_dct (uint_t size) {
     return s;
   }
 #endif
-  // falling back to plain mode
+  // falling back to generic mode
   AUBIO_WRN("dct: no optimised implementation could be created for size %d\n",
       size);
-plain:
-  s->dct = (void *)new_aubio_dct_plain (size);
+generic:
+  s->dct = (void *)new_aubio_dct_fft (size);
   if (s->dct) {
-    s->dct_do = (aubio_dct_do_t)aubio_dct_plain_do;
-    s->dct_rdo = (aubio_dct_rdo_t)aubio_dct_plain_rdo;
-    s->del_dct = (del_aubio_dct_t)del_aubio_dct_plain;
+    s->dct_do = (aubio_dct_do_t)aubio_dct_fft_do;
+    s->dct_rdo = (aubio_dct_rdo_t)aubio_dct_fft_rdo;
+    s->del_dct = (del_aubio_dct_t)del_aubio_dct_fft;
     return s;
   } else {
     goto beach;
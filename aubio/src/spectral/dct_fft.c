@@ -0,0 +1,281 @@
+/*
+  Copyright (C) 2022 Filipe Coelho <falktx@falktx.com>
+
+  This file is part of aubio.
+
+  aubio is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  aubio is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with aubio.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+/* DCT of any size, computed with the fft object of the current backend.
+
+   The input is reordered so that the DCT becomes the real part of a twiddled
+   DFT of the same length (Makhoul, 1980). That DFT is computed as a
+   convolution with a chirp (Bluestein), with ffts of a power of two length,
+   so that any size is supported whatever the fft backend is.
+
+   The chirps and the transform of the convolution kernel only depend on the
+   size, and are shared by all dct objects of that size. */
+
+#include "aubio_priv.h"
+#include "fvec.h"
+#include "cvec.h"
+#include "mathutils.h"
+#include "spectral/fft.h"
+#include "spectral/dct.h"
+
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
+
+typedef struct _aubio_dct_fft_tables_t aubio_dct_fft_tables_t;
+
+struct _aubio_dct_fft_tables_t {
+  uint_t size;              /** length of the dct */
+  uint_t count;             /** number of dct objects using these tables */
+  fvec_t *chirp_re;         /** exp(-i pi n^2 / size) [size] */
+  fvec_t *chirp_im;
+  fvec_t *twiddle_re;       /** chirp times exp(-i pi n / (2 size)) [size] */
+  fvec_t *twiddle_im;
+  fvec_t *kernel_re;        /** half the transform of the conjugate chirp */
+  fvec_t *kernel_im;        /** [fft_size / 2 + 1] */
+  aubio_dct_fft_tables_t *next;
+};
+
+static aubio_dct_fft_tables_t *aubio_dct_fft_tables = NULL;
+#ifdef HAVE_PTHREAD_H
+static pthread_mutex_t aubio_dct_fft_mutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+typedef struct _aubio_dct_fft_t aubio_dct_fft_t;
+
+struct _aubio_dct_fft_t {
+  uint_t size;
+  uint_t fft_size;          /** convolution length, a power of two */
+  aubio_fft_t *fft;
+  aubio_dct_fft_tables_t *tables;
+  fvec_t *re;               /** complex sequence being transformed [fft_size] */
+  fvec_t *im;
+  fvec_t *spec_re;          /** spectra of re and im [fft_size] */
+  fvec_t *spec_im;
+  smpl_t scalers[4];
+};
+
+void del_aubio_dct_fft (aubio_dct_fft_t *s);
+
+static aubio_dct_fft_tables_t *
+new_aubio_dct_fft_tables (aubio_dct_fft_t *s)
+{
+  aubio_dct_fft_tables_t *t = AUBIO_NEW(aubio_dct_fft_tables_t);
+  uint_t n, size = s->size, fft_size = s->fft_size;
+  t->size = size;
+  t->chirp_re = new_fvec(size);
+  t->chirp_im = new_fvec(size);
+  t->twiddle_re = new_fvec(size);
+  t->twiddle_im = new_fvec(size);
+  t->kernel_re = new_fvec(fft_size / 2 + 1);
+  t->kernel_im = new_fvec(fft_size / 2 + 1);
+  for (n = 0; n < size; n++) {
+    /* n^2 modulo 2 size keeps the phase accurate for long sizes */
+    double chirp = PI * (double)((unsigned long)n * n % (2 * size)) / size;
+    double twiddle = chirp + PI * n / (2. * size);
+    t->chirp_re->data[n] = cos(chirp);
+    t->chirp_im->data[n] = -sin(chirp);
+    t->twiddle_re->data[n] = cos(twiddle);
+    t->twiddle_im->data[n] = -sin(twiddle);
+  }
+  /* conjugate chirp, for lags -(size - 1) to size - 1, wrapped around */
+  fvec_zeros(s->re);
+  fvec_zeros(s->im);
+  for (n = 0; n < size; n++) {
+    s->re->data[n] = t->chirp_re->data[n];
+    s->im->data[n] = -t->chirp_im->data[n];
+    if (n > 0) {
+      s->re->data[fft_size - n] = s->re->data[n];
+      s->im->data[fft_size - n] = s->im->data[n];
+    }
+  }
+  aubio_fft_do_complex(s->fft, s->re, s->spec_re);
+  aubio_fft_do_complex(s->fft, s->im, s->spec_im);
+  /* the kernel is even, so is its transform, of which the real parts of both
+     spectra are enough */
+  for (n = 0; n <= fft_size / 2; n++) {
+    t->kernel_re->data[n] = .5 * s->spec_re->data[n];
+    t->kernel_im->data[n] = .5 * s->spec_im->data[n];
+  }
+  return t;
+}
+
+static void
+del_aubio_dct_fft_tables (aubio_dct_fft_tables_t *t)
+{
+  del_fvec(t->chirp_re);
+  del_fvec(t->chirp_im);
+  del_fvec(t->twiddle_re);
+  del_fvec(t->twiddle_im);
+  del_fvec(t->kernel_re);
+  del_fvec(t->kernel_im);
+  AUBIO_FREE(t);
+}
+
+aubio_dct_fft_t * new_aubio_dct_fft (uint_t size) {
+  aubio_dct_fft_t * s = AUBIO_NEW(aubio_dct_fft_t);
+  aubio_dct_fft_tables_t *t;
+  if ((sint_t)size <= 0) {
+    AUBIO_ERR("dct_fft: can only create with size > 0, requested %d\n",
+        size);
+    goto beach;
+  }
+  s->size = size;
+  /* long enough for a linear convolution, and for all fft backends */
+  s->fft_size = MAX(16, aubio_next_power_of_two(2 * size - 1));
+  s->fft = new_aubio_fft(s->fft_size);
+  if (!s->fft) goto beach;
+  s->re = new_fvec(s->fft_size);
+  s->im = new_fvec(s->fft_size);
+  s->spec_re = new_fvec(s->fft_size);
+  s->spec_im = new_fvec(s->fft_size);
+  s->scalers[0] = SQRT(1./size);
+  s->scalers[1] = SQRT(2./size);
+  s->scalers[2] = 1. / s->scalers[0];
+  s->scalers[3] = 1. / s->scalers[1];
+
+#ifdef HAVE_PTHREAD_H
+  pthread_mutex_lock(&aubio_dct_fft_mutex);
+#endif
+  for (t = aubio_dct_fft_tables; t; t = t->next) {
+    if (t->size == size) break;
+  }
+  if (!t) {
+    t = new_aubio_dct_fft_tables(s);
+    t->next = aubio_dct_fft_tables;
+    aubio_dct_fft_tables = t;
+  }
+  t->count++;
+  s->tables = t;
+#ifdef HAVE_PTHREAD_H
+  pthread_mutex_unlock(&aubio_dct_fft_mutex);
+#endif
+  return s;
+beach:
+  del_aubio_dct_fft(s);
+  return NULL;
+}
+
+void del_aubio_dct_fft (aubio_dct_fft_t *s) {
+  if (s->tables) {
+    aubio_dct_fft_tables_t **t;
+#ifdef HAVE_PTHREAD_H
+    pthread_mutex_lock(&aubio_dct_fft_mutex);
+#endif
+    if (--s->tables->count == 0) {
+      for (t = &aubio_dct_fft_tables; *t != s->tables; t = &(*t)->next);
+      *t = s->tables->next;
+      del_aubio_dct_fft_tables(s->tables);
+    }
+#ifdef HAVE_PTHREAD_H
+    pthread_mutex_unlock(&aubio_dct_fft_mutex);
+#endif
+  }
+  if (s->fft) del_aubio_fft(s->fft);
+  if (s->re) del_fvec(s->re);
+  if (s->im) del_fvec(s->im);
+  if (s->spec_re) del_fvec(s->spec_re);
+  if (s->spec_im) del_fvec(s->spec_im);
+  AUBIO_FREE(s);
+}
+
+/* convolve the first size elements of re + i im with the conjugate chirp,
+   the rest of both vectors having been cleared */
+static void
+aubio_dct_fft_convolve (aubio_dct_fft_t *s)
+{
+  const smpl_t *kre = s->tables->kernel_re->data;
+  const smpl_t *kim = s->tables->kernel_im->data;
+  smpl_t *sr = s->spec_re->data, *si = s->spec_im->data;
+  uint_t k, n = s->fft_size;
+
+  aubio_fft_do_complex(s->fft, s->re, s->spec_re);
+  aubio_fft_do_complex(s->fft, s->im, s->spec_im);
+
+  /* spectrum of re + i im at k and n - k, from the halves of both real
+     spectra, times the kernel. The products are split back in two halves,
+     the spectra of the real and imaginary parts of the convolution */
+  for (k = 0; k <= n / 2; k += n / 2) {
+    smpl_t rr = sr[k], ri = si[k];
+    sr[k] = 2. * (rr * kre[k] - ri * kim[k]);
+    si[k] = 2. * (rr * kim[k] + ri * kre[k]);
+  }
+  for (k = 1; k < n / 2; k++) {
+    uint_t j = n - k;
+    smpl_t rr = sr[k], ir = sr[j], ri = si[k], ii = si[j];
+    smpl_t ar = rr - ii, ai = ir + ri;   /* at k */
+    smpl_t br = rr + ii, bi = ri - ir;   /* at n - k */
+    smpl_t cr = ar * kre[k] - ai * kim[k];
+    smpl_t ci = ar * kim[k] + ai * kre[k];
+    smpl_t dr = br * kre[k] - bi * kim[k];
+    smpl_t di = br * kim[k] + bi * kre[k];
+    sr[k] = cr + dr;
+    si[k] = ci + di;
+    sr[j] = ci - di;
+    si[j] = dr - cr;
+  }
+
+  aubio_fft_rdo_complex(s->fft, s->spec_re, s->re);
+  aubio_fft_rdo_complex(s->fft, s->spec_im, s->im);
+}
+
+void aubio_dct_fft_do(aubio_dct_fft_t *s, const fvec_t *input, fvec_t *output) {
+  const aubio_dct_fft_tables_t *t = s->tables;
+  smpl_t *re = s->re->data, *im = s->im->data;
+  uint_t n, size = s->size;
+  /* even samples first, then odd samples backwards */
+  for (n = 0; n < size; n++) {
+    smpl_t v = input->data[n < (size + 1) / 2 ? 2 * n : 2 * (size - n) - 1];
+    re[n] = v * t->chirp_re->data[n];
+    im[n] = v * t->chirp_im->data[n];
+  }
+  memset(re + size, 0, (s->fft_size - size) * sizeof(smpl_t));
+  memset(im + size, 0, (s->fft_size - size) * sizeof(smpl_t));
+  aubio_dct_fft_convolve(s);
+  for (n = 0; n < size; n++) {
+    output->data[n] = (n == 0 ? s->scalers[0] : s->scalers[1])
+      * (t->twiddle_re->data[n] * re[n] - t->twiddle_im->data[n] * im[n]);
+  }
+}
+
+void aubio_dct_fft_rdo(aubio_dct_fft_t *s, const fvec_t *input, fvec_t *output) {
+  const aubio_dct_fft_tables_t *t = s->tables;
+  smpl_t *re = s->re->data, *im = s->im->data;
+  uint_t n, size = s->size;
+  smpl_t scale = 1. / size;
+  /* conjugate of the twiddled spectrum of the reordered output, whose
+     transform gives back that output, conjugated and size times larger */
+  re[0] = input->data[0] * s->scalers[2];
+  im[0] = 0.;
+  for (n = 1; n < size; n++) {
+    smpl_t xr = input->data[n] * s->scalers[3];
+    smpl_t xi = input->data[size - n] * s->scalers[3];
+    re[n] = t->twiddle_re->data[n] * xr - t->twiddle_im->data[n] * xi;
+    im[n] = t->twiddle_re->data[n] * xi + t->twiddle_im->data[n] * xr;
+  }
+  memset(re + size, 0, (s->fft_size - size) * sizeof(smpl_t));
+  memset(im + size, 0, (s->fft_size - size) * sizeof(smpl_t));
+  aubio_dct_fft_convolve(s);
+  for (n = 0; n < size; n++) {
+    smpl_t v = scale
+      * (t->chirp_re->data[n] * re[n] - t->chirp_im->data[n] * im[n]);
+    output->data[n < (size + 1) / 2 ? 2 * n : 2 * (size - n) - 1] = v;
+  }
+}
@@ -35,8 +35,52 @@ struct _aubio_filterbank_t
   fmat_t *filters;
   smpl_t norm;
   smpl_t power;
+  uint_t *band_start;   /**< first non-zero coefficient of each filter */
+  uint_t *band_end;     /**< one past the last non-zero coefficient */
 };
 
+/* find the range of non-zero coefficients of each filter, so that
+   aubio_filterbank_do only multiplies the band each filter covers */
+static void
+aubio_filterbank_update_bands (aubio_filterbank_t * f)
+{
+  uint_t i;
+  for (i = 0; i < f->filters->height; i++) {
+    const smpl_t *row = f->filters->data[i];
+    uint_t start = 0, end = f->filters->length;
+    while (start < end && row[start] == 0.) start++;
+    while (end > start && row[end - 1] == 0.) end--;
+    f->band_start[i] = start;
+    f->band_end[i] = end;
+  }
+}
+
+static smpl_t
+aubio_filterbank_dot (const smpl_t * a, const smpl_t * b, uint_t length)
+{
+#if defined(HAVE_BLAS)
+  return aubio_cblas_dot (length, a, 1, b, 1);
+#elif defined(HAVE_ACCELERATE)
+  smpl_t sum;
+  aubio_vDSP_dotpr (a, 1, b, 1, &sum, length);
+  return sum;
+#else
+  /* independent partial sums let the compiler keep several in flight */
+  smpl_t s0 = 0., s1 = 0., s2 = 0., s3 = 0.;
+  uint_t j;
+  for (j = 0; j + 4 <= length; j += 4) {
+    s0 += a[j] * b[j];
+    s1 += a[j + 1] * b[j + 1];
+    s2 += a[j + 2] * b[j + 2];
+    s3 += a[j + 3] * b[j + 3];
+  }
+  for (; j < length; j++) {
+    s0 += a[j] * b[j];
+  }
+  return (s0 + s1) + (s2 + s3);
+#endif
+}
+
 aubio_filterbank_t *
 new_aubio_filterbank (uint_t n_filters, uint_t win_s)
 {
@@ -56,6 +100,9 @@ new_aubio_filterbank (uint_t n_filters, uint_t win_s)
 
   /* allocate filter tables, a matrix of length win_s and of height n_filters */
   fb->filters = new_fmat (n_filters, win_s / 2 + 1);
+  fb->band_start = AUBIO_ARRAY (uint_t, n_filters);
+  /* all zeros, as the filters, for which the bands are empty */
+  fb->band_end = AUBIO_ARRAY (uint_t, n_filters);
 
   fb->norm = 1;
 
@@ -71,12 +118,15 @@ void
 del_aubio_filterbank (aubio_filterbank_t * fb)
 {
   del_fmat (fb->filters);
+  AUBIO_FREE (fb->band_start);
+  AUBIO_FREE (fb->band_end);
   AUBIO_FREE (fb);
 }
 
 void
 aubio_filterbank_do (aubio_filterbank_t * f, const cvec_t * in, fvec_t * out)
 {
+  uint_t i;
   /* apply filter to all input channel, provided out has enough channels */
   //uint_t max_filters = MIN (f->n_filters, out->length);
   //uint_t max_length = MIN (in->length, f->filters->length);
@@ -88,7 +138,12 @@ aubio_filterbank_do (aubio_filterbank_t * f, const cvec_t * in, fvec_t * out)
 
   if (f->power != 1.) fvec_pow(&tmp, f->power);
 
-  fmat_vecmul(f->filters, &tmp, out);
+  // each filter only covers a few bins, skip the zeros around them
+  for (i = 0; i < f->filters->height; i++) {
+    uint_t start = f->band_start[i];
+    out->data[i] = aubio_filterbank_dot (f->filters->data[i] + start,
+        tmp.data + start, f->band_end[i] - start);
+  }
 
   return;
 }
@@ -102,7 +157,10 @@ aubio_filterbank_get_coeffs (const aubio_filterbank_t * f)
 uint_t
 aubio_filterbank_set_coeffs (aubio_filterbank_t * f, const fmat_t * filter_coeffs)
 {
-  fmat_copy(filter_coeffs, f->filters);
+  if (filter_coeffs != f->filters) {
+    fmat_copy(filter_coeffs, f->filters);
+  }
+  aubio_filterbank_update_bands (f);
   return 0;
 }
 
@@ -72,13 +72,18 @@ void aubio_filterbank_do (aubio_filterbank_t * f, const cvec_t * in, fvec_t * ou
 
   \param f filterbank object, as returned by new_aubio_filterbank()
 
+  aubio_filterbank_do() skips the leading and trailing zeros of each filter.
+  After changing the coefficients through the returned matrix, pass it to
+  aubio_filterbank_set_coeffs() so that these are found again.
+
  */
 fmat_t *aubio_filterbank_get_coeffs (const aubio_filterbank_t * f);
 
 /** copy filter coefficients to the filterbank
 
   \param f filterbank object, as returned by new_aubio_filterbank()
-  \param filters filter bank coefficients to copy from
+  \param filters filter bank coefficients to copy from, or the matrix
+  returned by aubio_filterbank_get_coeffs() once it was changed
 
  */
 uint_t aubio_filterbank_set_coeffs (aubio_filterbank_t * f, const fmat_t * filters);
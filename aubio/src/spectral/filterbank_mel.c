@@ -163,7 +163,8 @@ aubio_filterbank_set_triangle_bands (aubio_filterbank_t * fb,
   del_fvec (triangle_heights);
   del_fvec (fft_freqs);
 
-  return AUBIO_OK;
+  /* let the filterbank find the bands of the new filters */
+  return aubio_filterbank_set_coeffs (fb, filters);
 }
 
 uint_t
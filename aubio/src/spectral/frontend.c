@@ -0,0 +1,159 @@
+/*
+  Copyright (C) 2022 Filipe Coelho <falktx@falktx.com>
+
+  This file is part of aubio.
+
+  aubio is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  aubio is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with aubio.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "aubio_priv.h"
+#include "fvec.h"
+#include "cvec.h"
+#include "mathutils.h"
+#include "spectral/fft.h"
+#include "spectral/frontend.h"
+
+/** spectral front end internal object */
+struct _aubio_frontend_t {
+  uint_t buf_s;         /** analysis buffer size */
+  uint_t hop_s;         /** step between two analysis */
+  uint_t pos;           /** write position in ring, also oldest sample */
+  uint_t shift;         /** rotation applied by fvec_shift */
+  fvec_t * ring;        /** last [buf_s] input samples */
+  fvec_t * w;           /** analysis window [buf_s] */
+  fvec_t * grain;       /** windowed and shifted grain [buf_s] */
+  aubio_fft_t * fft;    /** fft object */
+  fvec_t * compspec;    /** complex spectrum [buf_s] */
+  cvec_t * spectrum;    /** norm and phase spectrum [buf_s / 2 + 1] */
+  uint_t count;         /** number of consumers */
+  aubio_frontend_consumer_t consumers[AUBIO_FRONTEND_MAX_CONSUMERS];
+  void * data[AUBIO_FRONTEND_MAX_CONSUMERS];
+};
+
+aubio_frontend_t * new_aubio_frontend (uint_t buf_size, uint_t hop_size)
+{
+  aubio_frontend_t * f = AUBIO_NEW(aubio_frontend_t);
+
+  if ((sint_t)hop_size < 1) {
+    AUBIO_ERR("frontend: got hop_size %d, but can not be < 1\n", hop_size);
+    goto beach;
+  } else if ((sint_t)buf_size < 2) {
+    AUBIO_ERR("frontend: got buffer_size %d, but can not be < 2\n", buf_size);
+    goto beach;
+  } else if (buf_size < hop_size) {
+    AUBIO_ERR("frontend: hop size (%d) is larger than win size (%d)\n",
+        hop_size, buf_size);
+    goto beach;
+  }
+
+  f->fft = new_aubio_fft (buf_size);
+  if (f->fft == NULL) {
+    goto beach;
+  }
+
+  f->buf_s = buf_size;
+  f->hop_s = hop_size;
+  f->pos = 0;
+  // fvec_shift rotates left by half the size, rounded up
+  f->shift = buf_size - (buf_size + 1) / 2;
+  f->ring = new_fvec (buf_size);
+  f->w = new_aubio_window ("hanningz", buf_size);
+  f->grain = new_fvec (buf_size);
+  f->compspec = new_fvec (buf_size);
+  f->spectrum = new_cvec (buf_size);
+  f->count = 0;
+
+  return f;
+
+beach:
+  AUBIO_FREE (f);
+  return NULL;
+}
+
+uint_t aubio_frontend_add (aubio_frontend_t * f,
+    aubio_frontend_consumer_t consumer, void * data)
+{
+  if (f->count >= AUBIO_FRONTEND_MAX_CONSUMERS) {
+    AUBIO_ERR("frontend: can not add more than %d consumers\n",
+        AUBIO_FRONTEND_MAX_CONSUMERS);
+    return AUBIO_FAIL;
+  }
+  f->consumers[f->count] = consumer;
+  f->data[f->count] = data;
+  f->count++;
+  return AUBIO_OK;
+}
+
+void aubio_frontend_do (aubio_frontend_t * f, const fvec_t * input)
+{
+  smpl_t * ring = f->ring->data;
+  smpl_t * w = f->w->data;
+  smpl_t * grain = f->grain->data;
+  uint_t i, r, k;
+
+  /* write new samples over the oldest ones */
+  for (i = 0; i < f->hop_s; i++) {
+    ring[f->pos] = input->data[i];
+    if (++f->pos == f->buf_s) f->pos = 0;
+  }
+
+  /* window and shift in one pass, same result as pvoc without moving the
+     buffer around */
+  r = f->pos;
+  k = f->shift;
+  for (i = 0; i < f->buf_s; i++) {
+    grain[k] = ring[r] * w[i];
+    if (++r == f->buf_s) r = 0;
+    if (++k == f->buf_s) k = 0;
+  }
+
+  aubio_fft_do_complex (f->fft, f->grain, f->compspec);
+  aubio_fft_get_spectrum (f->compspec, f->spectrum);
+
+  for (i = 0; i < f->count; i++) {
+    f->consumers[i] (f->data[i], input, f->spectrum);
+  }
+}
+
+const cvec_t * aubio_frontend_get_spectrum (const aubio_frontend_t * f)
+{
+  return f->spectrum;
+}
+
+const fvec_t * aubio_frontend_get_complex (const aubio_frontend_t * f)
+{
+  return f->compspec;
+}
+
+uint_t aubio_frontend_get_buf_size (const aubio_frontend_t * f)
+{
+  return f->buf_s;
+}
+
+uint_t aubio_frontend_get_hop_size (const aubio_frontend_t * f)
+{
+  return f->hop_s;
+}
+
+void del_aubio_frontend (aubio_frontend_t * f)
+{
+  del_fvec (f->ring);
+  del_fvec (f->w);
+  del_fvec (f->grain);
+  del_fvec (f->compspec);
+  del_cvec (f->spectrum);
+  del_aubio_fft (f->fft);
+  AUBIO_FREE (f);
+}
@@ -0,0 +1,135 @@
+/*
+  Copyright (C) 2022 Filipe Coelho <falktx@falktx.com>
+
+  This file is part of aubio.
+
+  aubio is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  aubio is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with aubio.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+/** \file
+
+  Shared spectral front end
+
+  This object slides the input signal into an analysis buffer, applies a
+  HanningZ window and computes a single FFT per hop, exactly like
+  aubio_pvoc_do(). The resulting spectrum is then handed to every registered
+  consumer, so that several analysers working on the same buffer and hop sizes
+  (for instance pitch detection with aubio_pitch_do_spectrum() and onset
+  detection with aubio_onset_do_spectrum()) share one FFT instead of computing
+  their own.
+
+  Consumers are called in the order they were added, and must not modify the
+  spectrum. Analysers modifying their spectral frame in place (for instance
+  onset detection with whitening or compression enabled) work on a copy.
+
+*/
+
+#ifndef AUBIO_FRONTEND_H
+#define AUBIO_FRONTEND_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** maximum number of consumers of a spectral front end */
+#define AUBIO_FRONTEND_MAX_CONSUMERS 16
+
+/** spectral front end object */
+typedef struct _aubio_frontend_t aubio_frontend_t;
+
+/** spectrum consumer callback
+
+  \param data user data, as passed to aubio_frontend_add()
+  \param input new input samples of this hop, [hop_size]
+  \param spectrum spectral frame of the last [buf_size] samples
+
+*/
+typedef void (*aubio_frontend_consumer_t) (void * data, const fvec_t * input,
+    const cvec_t * spectrum);
+
+/** create spectral front end object
+
+  \param buf_size size of analysis buffer (and length the FFT transform)
+  \param hop_size step size between two consecutive analysis
+
+*/
+aubio_frontend_t * new_aubio_frontend (uint_t buf_size, uint_t hop_size);
+
+/** add a consumer to a spectral front end
+
+  \param f spectral front end object as returned by new_aubio_frontend()
+  \param consumer callback called with each new spectral frame
+  \param data user data passed to `consumer`
+
+  \return 0 on success, non-zero if ::AUBIO_FRONTEND_MAX_CONSUMERS were
+  already added
+
+*/
+uint_t aubio_frontend_add (aubio_frontend_t * f,
+    aubio_frontend_consumer_t consumer, void * data);
+
+/** compute spectral frame and pass it to all consumers
+
+  \param f spectral front end object as returned by new_aubio_frontend()
+  \param input new input signal, [hop_size]
+
+*/
+void aubio_frontend_do (aubio_frontend_t * f, const fvec_t * input);
+
+/** get last computed spectral frame
+
+  \param f spectral front end object as returned by new_aubio_frontend()
+
+  \return norm and phase of the last frame, as computed by aubio_pvoc_do()
+
+*/
+const cvec_t * aubio_frontend_get_spectrum (const aubio_frontend_t * f);
+
+/** get last computed complex spectrum
+
+  \param f spectral front end object as returned by new_aubio_frontend()
+
+  \return real and imaginary parts of the last frame, as computed by
+  aubio_fft_do_complex()
+
+*/
+const fvec_t * aubio_frontend_get_complex (const aubio_frontend_t * f);
+
+/** get analysis buffer size
+
+  \param f spectral front end object as returned by new_aubio_frontend()
+
+*/
+uint_t aubio_frontend_get_buf_size (const aubio_frontend_t * f);
+
+/** get hop size
+
+  \param f spectral front end object as returned by new_aubio_frontend()
+
+*/
+uint_t aubio_frontend_get_hop_size (const aubio_frontend_t * f);
+
+/** delete spectral front end object
+
+  \param f spectral front end object as returned by new_aubio_frontend()
+
+*/
+void del_aubio_frontend (aubio_frontend_t * f);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AUBIO_FRONTEND_H */
@@ -157,6 +157,11 @@ void del_aubio_pvoc(aubio_pvoc_t *pv) {
   AUBIO_FREE(pv);
 }
 
+void aubio_pvoc_reset(aubio_pvoc_t *pv) {
+  fvec_zeros(pv->dataold);
+  fvec_zeros(pv->synthold);
+}
+
 static void aubio_pvoc_swapbuffers(aubio_pvoc_t *pv, const fvec_t *new)
 {
   /* some convenience pointers */
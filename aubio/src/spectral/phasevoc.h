@@ -82,6 +82,15 @@ void aubio_pvoc_do(aubio_pvoc_t *pv, const fvec_t *in, cvec_t * fftgrain);
 */
 void aubio_pvoc_rdo(aubio_pvoc_t *pv, cvec_t * fftgrain, fvec_t *out);
 
+/** reset phase vocoder memory
+
+  \param pv phase vocoder object as returned by new_aubio_pvoc
+
+  Clears the past input and output grains, as if the object was new.
+
+*/
+void aubio_pvoc_reset(aubio_pvoc_t *pv);
+
 /** get window size
 
   \param pv phase vocoder to get the window size from
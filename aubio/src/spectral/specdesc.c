@@ -86,6 +86,78 @@ struct _aubio_specdesc_t {
   aubio_hist_t * histog; /**< histogram */
 };
 
+/* The onset functions below run once per bin and per frame. Their loops are
+   kept free of branches and function calls, and accumulate in local
+   variables, so that the compiler can vectorise them. The math.h functions
+   they need are replaced with the approximations below, whose errors are
+   below those of the float spectrum they are applied to. */
+
+/* phase wrapped to [-pi, pi], same as aubio_unwrap2pi(). The turns are
+   removed in double precision, which keeps the result exact to the float
+   rounding whatever the compiler reorders, -ffast-math included */
+static inline smpl_t
+aubio_specdesc_unwrap (smpl_t phase)
+{
+  double turns = phase * (1. / TWO_PI);
+  turns = (double)(sint_t)(turns + (turns < 0 ? -.5 : .5));
+  return (smpl_t)(phase - turns * TWO_PI);
+}
+
+/* cosine, within 3.e-7 of the exact value for |x| < 4 pi: the phase is
+   wrapped to [-pi, pi] and folded to [0, pi/2], where the Taylor series up to
+   x^12 is used */
+static inline smpl_t
+aubio_specdesc_cos (smpl_t x)
+{
+  smpl_t a = ABS(aubio_specdesc_unwrap(x));
+  smpl_t sign = a > (smpl_t)(PI / 2.) ? -1.f : 1.f;
+  smpl_t y = a > (smpl_t)(PI / 2.) ? (smpl_t)PI - a : a;
+  smpl_t y2 = y * y;
+  return sign * (1.f + y2 * (-1.f / 2.f + y2 * (1.f / 24.f
+            + y2 * (-1.f / 720.f + y2 * (1.f / 40320.f
+            + y2 * (-1.f / 3628800.f + y2 * (1.f / 479001600.f)))))));
+}
+
+/* natural logarithm of a positive finite x, within a relative error of
+   1.2e-7. The exponent is read from the float bits, and the logarithm of the
+   mantissa, brought to [sqrt(1/2), sqrt(2)], is computed with the polynomial
+   of cephes' logf */
+static inline smpl_t
+aubio_specdesc_log (smpl_t x)
+{
+  union { smpl_t f; uint_t i; } u;
+  smpl_t e, m, z, z2, p;
+  u.f = x;
+  e = (smpl_t)((sint_t)(u.i >> 23) - 127);
+  u.i = (u.i & 0x007fffff) | 0x3f800000;
+  m = u.f;
+  e = m > 1.41421356f ? e + 1.f : e;
+  m = m > 1.41421356f ? .5f * m : m;
+  z = m - 1.f;
+  z2 = z * z;
+  p = 7.0376836292e-2f;
+  p = p * z - 1.1514610310e-1f;
+  p = p * z + 1.1676998740e-1f;
+  p = p * z - 1.2420140846e-1f;
+  p = p * z + 1.4249322787e-1f;
+  p = p * z - 1.6668057665e-1f;
+  p = p * z + 2.0000714765e-1f;
+  p = p * z - 2.4999993993e-1f;
+  p = p * z + 3.3333331174e-1f;
+  return z + z2 * (z * p - .5f) + e * 0.693147180559945f;
+}
+
+/* The phase history is kept as two vectors used in turn: once the previous
+   phases have been used, the current phases are written over the oldest
+   ones, and both vectors swap roles, instead of moving both histories down
+   each frame. */
+static inline void
+aubio_specdesc_swap_phases (aubio_specdesc_t *o)
+{
+  fvec_t *theta = o->theta1;
+  o->theta1 = o->theta2;
+  o->theta2 = theta;
+}
 
 /* Energy based onset detection function */
 void aubio_specdesc_energy  (aubio_specdesc_t *o UNUSED,
@@ -100,58 +172,62 @@ void aubio_specdesc_energy  (aubio_specdesc_t *o UNUSED,
 /* High Frequency Content onset detection function */
 void aubio_specdesc_hfc(aubio_specdesc_t *o UNUSED,
     const cvec_t * fftgrain, fvec_t * onset){
+  const smpl_t *norm = fftgrain->norm;
+  smpl_t hfc = 0.;
   uint_t j;
-  onset->data[0] = 0.;
   for (j=0;j<fftgrain->length;j++) {
-    onset->data[0] += (j+1)*fftgrain->norm[j];
+    hfc += (smpl_t)(j+1)*norm[j];
   }
+  onset->data[0] = hfc;
 }
 
 
 /* Complex Domain Method onset detection function */
 void aubio_specdesc_complex (aubio_specdesc_t *o, const cvec_t * fftgrain, fvec_t * onset) {
+  const smpl_t *norm = fftgrain->norm, *phas = fftgrain->phas;
+  smpl_t *oldmag = o->oldmag->data;
+  const smpl_t *theta1 = o->theta1->data;
+  smpl_t *theta2 = o->theta2->data;
+  smpl_t dist = 0.;
   uint_t j;
   uint_t nbins = fftgrain->length;
-  onset->data[0] = 0.;
   for (j=0;j<nbins; j++)  {
     // compute the predicted phase
-    o->dev1->data[j] = 2. * o->theta1->data[j] - o->theta2->data[j];
+    smpl_t predicted = 2 * theta1[j] - theta2[j];
     // compute the euclidean distance in the complex domain
     // sqrt ( r_1^2 + r_2^2 - 2 * r_1 * r_2 * \cos ( \phi_1 - \phi_2 ) )
-    onset->data[0] +=
-      SQRT (ABS (SQR (o->oldmag->data[j]) + SQR (fftgrain->norm[j])
-            - 2 * o->oldmag->data[j] * fftgrain->norm[j]
-            * COS (o->dev1->data[j] - fftgrain->phas[j])));
-    /* swap old phase data (need to remember 2 frames behind)*/
-    o->theta2->data[j] = o->theta1->data[j];
-    o->theta1->data[j] = fftgrain->phas[j];
-    /* swap old magnitude data (1 frame is enough) */
-    o->oldmag->data[j] = fftgrain->norm[j];
+    dist += SQRT (ABS (SQR (oldmag[j]) + SQR (norm[j])
+            - 2 * oldmag[j] * norm[j]
+            * aubio_specdesc_cos (predicted - phas[j])));
+    /* the oldest phases are not needed anymore */
+    theta2[j] = phas[j];
+    /* 1 frame of magnitude is enough */
+    oldmag[j] = norm[j];
   }
+  aubio_specdesc_swap_phases(o);
+  onset->data[0] = dist;
 }
 
 
 /* Phase Based Method onset detection function */
 void aubio_specdesc_phase(aubio_specdesc_t *o, 
     const cvec_t * fftgrain, fvec_t * onset){
+  const smpl_t *norm = fftgrain->norm, *phas = fftgrain->phas;
+  const smpl_t *theta1 = o->theta1->data;
+  smpl_t *theta2 = o->theta2->data, *dev1 = o->dev1->data;
+  smpl_t threshold = o->threshold;
   uint_t j;
   uint_t nbins = fftgrain->length;
-  onset->data[0] = 0.0;
-  o->dev1->data[0]=0.;
   for ( j=0;j<nbins; j++ )  {
-    o->dev1->data[j] = 
-      aubio_unwrap2pi(
-          fftgrain->phas[j]
-          -2.0*o->theta1->data[j]
-          +o->theta2->data[j]);
-    if ( o->threshold < fftgrain->norm[j] )
-      o->dev1->data[j] = ABS(o->dev1->data[j]);
-    else 
-      o->dev1->data[j] = 0.0;
+    /* summed in double precision as before, the histogram below can move a
+       deviation to another class for a 1 ulp difference */
+    smpl_t dev = ABS (aubio_specdesc_unwrap (phas[j]
+          - 2. * theta1[j] + theta2[j]));
+    dev1[j] = threshold < norm[j] ? dev : 0.f;
     /* keep a track of the past frames */
-    o->theta2->data[j] = o->theta1->data[j];
-    o->theta1->data[j] = fftgrain->phas[j];
+    theta2[j] = phas[j];
   }
+  aubio_specdesc_swap_phases(o);
   /* apply o->histogram */
   aubio_hist_dyn_notnull(o->histog,o->dev1);
   /* weight it */
@@ -165,10 +241,12 @@ void aubio_specdesc_phase(aubio_specdesc_t *o,
 void
 aubio_specdesc_wphase(aubio_specdesc_t *o,
     const cvec_t *fftgrain, fvec_t *onset) {
+  const smpl_t *norm = fftgrain->norm;
+  smpl_t *dev1 = o->dev1->data;
   uint_t i;
   aubio_specdesc_phase(o, fftgrain, onset);
   for (i = 0; i < fftgrain->length; i++) {
-    o->dev1->data[i] *= fftgrain->norm[i];
+    dev1[i] *= norm[i];
   }
   /* apply o->histogram */
   aubio_hist_dyn_notnull(o->histog,o->dev1);
@@ -181,18 +259,15 @@ aubio_specdesc_wphase(aubio_specdesc_t *o,
 /* Spectral difference method onset detection function */
 void aubio_specdesc_specdiff(aubio_specdesc_t *o,
     const cvec_t * fftgrain, fvec_t * onset){
+  const smpl_t *norm = fftgrain->norm;
+  smpl_t *oldmag = o->oldmag->data, *dev1 = o->dev1->data;
+  smpl_t threshold = o->threshold;
   uint_t j;
   uint_t nbins = fftgrain->length;
-    onset->data[0] = 0.0;
     for (j=0;j<nbins; j++)  {
-      o->dev1->data[j] = SQRT(
-          ABS(SQR( fftgrain->norm[j])
-            - SQR(o->oldmag->data[j])));
-      if (o->threshold < fftgrain->norm[j] )
-        o->dev1->data[j] = ABS(o->dev1->data[j]);
-      else 
-        o->dev1->data[j] = 0.0;
-      o->oldmag->data[j] = fftgrain->norm[j];
+      smpl_t dev = SQRT(ABS(SQR(norm[j]) - SQR(oldmag[j])));
+      dev1[j] = threshold < norm[j] ? dev : 0.f;
+      oldmag[j] = norm[j];
     }
 
     /* apply o->histogram (act somewhat as a low pass on the
@@ -208,38 +283,46 @@ void aubio_specdesc_specdiff(aubio_specdesc_t *o,
  * note we use ln(1+Xn/(Xn-1+0.0001)) to avoid 
  * negative (1.+) and infinite values (+1.e-10) */
 void aubio_specdesc_kl(aubio_specdesc_t *o, const cvec_t * fftgrain, fvec_t * onset){
+  const smpl_t *norm = fftgrain->norm;
+  smpl_t *oldmag = o->oldmag->data;
+  smpl_t kl = 0.;
   uint_t j;
-    onset->data[0] = 0.;
     for (j=0;j<fftgrain->length;j++) {
-      onset->data[0] += fftgrain->norm[j]
-        *LOG(1.+fftgrain->norm[j]/(o->oldmag->data[j]+1.e-1));
-      o->oldmag->data[j] = fftgrain->norm[j];
+      kl += norm[j]
+        *aubio_specdesc_log(1.f+norm[j]/(oldmag[j]+1.e-1f));
+      oldmag[j] = norm[j];
     }
-    if (isnan(onset->data[0])) onset->data[0] = 0.;
+    onset->data[0] = isnan(kl) ? 0. : kl;
 }
 
 /* Modified Kullback Liebler onset detection function
  * note we use ln(1+Xn/(Xn-1+0.0001)) to avoid 
  * negative (1.+) and infinite values (+1.e-10) */
 void aubio_specdesc_mkl(aubio_specdesc_t *o, const cvec_t * fftgrain, fvec_t * onset){
+  const smpl_t *norm = fftgrain->norm;
+  smpl_t *oldmag = o->oldmag->data;
+  smpl_t mkl = 0.;
   uint_t j;
-    onset->data[0] = 0.;
     for (j=0;j<fftgrain->length;j++) {
-      onset->data[0] += LOG(1.+fftgrain->norm[j]/(o->oldmag->data[j]+1.e-1));
-      o->oldmag->data[j] = fftgrain->norm[j];
+      mkl += aubio_specdesc_log(1.f+norm[j]/(oldmag[j]+1.e-1f));
+      oldmag[j] = norm[j];
     }
-    if (isnan(onset->data[0])) onset->data[0] = 0.;
+    onset->data[0] = isnan(mkl) ? 0. : mkl;
 }
 
 /* Spectral flux */
 void aubio_specdesc_specflux(aubio_specdesc_t *o, const cvec_t * fftgrain, fvec_t * onset){ 
+  const smpl_t *norm = fftgrain->norm;
+  smpl_t *oldmag = o->oldmag->data;
+  smpl_t flux = 0.;
   uint_t j;
-  onset->data[0] = 0.;
   for (j=0;j<fftgrain->length;j++) {
-    if (fftgrain->norm[j] > o->oldmag->data[j])
-      onset->data[0] += fftgrain->norm[j] - o->oldmag->data[j];
-    o->oldmag->data[j] = fftgrain->norm[j];
+    /* twice the positive part of the difference, without a branch */
+    smpl_t diff = norm[j] - oldmag[j];
+    flux += diff + ABS(diff);
+    oldmag[j] = norm[j];
   }
+  onset->data[0] = .5f * flux;
 }
 
 /* Generic function pointing to the choosen one */
@@ -310,7 +393,6 @@ new_aubio_specdesc (const char_t * onset_mode, uint_t size){
       /* the other approaches will need some more memory spaces */
     case aubio_onset_complex:
       o->oldmag = new_fvec(rsize);
-      o->dev1   = new_fvec(rsize);
       o->theta1 = new_fvec(rsize);
       o->theta2 = new_fvec(rsize);
       break;
@@ -401,7 +483,6 @@ void del_aubio_specdesc (aubio_specdesc_t *o){
       break;
     case aubio_onset_complex:
       del_fvec(o->oldmag);
-      del_fvec(o->dev1);
       del_fvec(o->theta1);
       del_fvec(o->theta2);
       break;
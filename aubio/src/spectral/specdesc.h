@@ -147,6 +147,9 @@
   This function returns the bin number below which 95% of the spectrum energy
   is found.
 
+  All the shape descriptors above can also be computed at once with
+  aubio_specdesc_statistics(), which is faster than running each of them.
+
   \example spectral/test-specdesc.c
 
 */
@@ -197,6 +200,32 @@ aubio_specdesc_t *new_aubio_specdesc (const char_t * method, uint_t buf_size);
 */
 void del_aubio_specdesc (aubio_specdesc_t * o);
 
+/** positions of the values computed by aubio_specdesc_statistics() */
+typedef enum {
+  aubio_specstat_sum = 0,   /**< sum of the spectrum norms */
+  aubio_specstat_centroid,  /**< spectral centroid, in bin */
+  aubio_specstat_spread,    /**< spectral spread */
+  aubio_specstat_skewness,  /**< spectral skewness */
+  aubio_specstat_kurtosis,  /**< spectral kurtosis */
+  aubio_specstat_slope,     /**< spectral slope */
+  aubio_specstat_decrease,  /**< spectral decrease */
+  aubio_specstat_rolloff,   /**< spectral roll-off, in bin */
+  aubio_specstat_count      /**< number of values */
+} aubio_specstat_type;
+
+/** compute all spectral shape descriptors of a spectral frame
+
+  \param fftgrain input signal spectrum as computed by aubio_pvoc_do
+  \param stats output vector, at least ::aubio_specstat_count long, indexed
+  by ::aubio_specstat_type
+
+  The descriptors match those of the methods of the same name, up to rounding.
+  Their moments are accumulated together in a single pass over the spectrum,
+  only the roll-off scans the bins below it again.
+
+*/
+void aubio_specdesc_statistics (const cvec_t * fftgrain, fvec_t * stats);
+
 #ifdef __cplusplus
 }
 #endif
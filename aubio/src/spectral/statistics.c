@@ -19,6 +19,7 @@
 */
 
 #include "aubio_priv.h"
+#include "fvec.h"
 #include "cvec.h"
 #include "spectral/specdesc.h"
 
@@ -202,3 +203,77 @@ aubio_specdesc_rolloff (aubio_specdesc_t *o UNUSED, const cvec_t * spec,
     desc->data[0] = j;
   }
 }
+
+void
+aubio_specdesc_statistics (const cvec_t * spec, fvec_t * stats)
+{
+  uint_t j, length = spec->length;
+  smpl_t *out = stats->data;
+  /* moments about bin 0, in double precision as the central moments are
+     obtained by subtracting them */
+  double s0 = 0., s1 = 0., s2 = 0., s3 = 0., s4 = 0., dec = 0., harm = 0.;
+  double centroid, spread, n = length;
+  smpl_t energy = 0., rollsum = 0.;
+
+  if (stats->length < aubio_specstat_count) {
+    AUBIO_ERR("specdesc: statistics need %u elements, got %u\n",
+        (uint_t)aubio_specstat_count, stats->length);
+    return;
+  }
+
+  if (length > 0) {
+    s0 = spec->norm[0];
+    energy = SQR (spec->norm[0]);
+  }
+  for (j = 1; j < length; j++) {
+    double m = spec->norm[j], jm = j * m, jjm = j * jm, inv = 1. / j;
+    s0 += m;
+    s1 += jm;
+    s2 += jjm;
+    s3 += j * jjm;
+    s4 += (double)j * j * jjm;
+    dec += m * inv;
+    harm += inv;
+    energy += SQR (spec->norm[j]);
+  }
+
+  fvec_zeros (stats);
+  out[aubio_specstat_sum] = s0;
+  if (s0 == 0.) return;
+
+  centroid = s1 / s0;
+  spread = MAX (0., s2 / s0 - centroid * centroid);
+  out[aubio_specstat_centroid] = centroid;
+  out[aubio_specstat_spread] = spread;
+  if (spread > 0.) {
+    double c2 = centroid * centroid;
+    double m3 = s3 / s0 - 3. * centroid * s2 / s0 + 2. * c2 * centroid;
+    double m4 = s4 / s0 - 4. * centroid * s3 / s0 + 6. * c2 * s2 / s0
+      - 3. * c2 * c2;
+    out[aubio_specstat_skewness] = m3 / (spread * SQRT (spread));
+    out[aubio_specstat_kurtosis] = m4 / (spread * spread);
+  }
+
+  /* linear regression of the norms on the bin index, with sum(j) and
+     sum(j^2) over 0 .. length - 1 in closed form */
+  if (length > 1) {
+    double sj = n * (n - 1.) / 2., sjj = (n - 1.) * n * (2. * n - 1.) / 6.;
+    out[aubio_specstat_slope] = (n * s1 - s0 * sj) / (n * sjj - sj * sj) / s0;
+  }
+
+  if (s0 != spec->norm[0]) {
+    out[aubio_specstat_decrease] = (dec - spec->norm[0] * harm)
+      / (s0 - spec->norm[0]);
+  }
+
+  /* same accumulation as aubio_specdesc_rolloff, so the bin is identical */
+  if (energy != 0.) {
+    energy *= 0.95;
+    j = 0;
+    while (rollsum < energy) {
+      rollsum += SQR (spec->norm[j]);
+      j++;
+    }
+    out[aubio_specstat_rolloff] = j;
+  }
+}
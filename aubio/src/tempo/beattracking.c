@@ -20,7 +20,9 @@
 
 #include "aubio_priv.h"
 #include "fvec.h"
+#include "cvec.h"
 #include "mathutils.h"
+#include "spectral/fft.h"
 #include "tempo/beattracking.h"
 
 /** define to 1 to print out tracking difficulties */
@@ -28,6 +30,10 @@
 
 uint_t fvec_gettimesig (fvec_t * acf, uint_t acflen, uint_t gp);
 void aubio_beattracking_checkstate (aubio_beattracking_t * bt);
+static void aubio_beattracking_autocorr (aubio_beattracking_t * bt,
+    const fvec_t * dfframe);
+static void aubio_beattracking_combfb (const fvec_t * acf, fvec_t * acfout,
+    uint_t numelem, uint_t weighted);
 
 struct _aubio_beattracking_t
 {
@@ -40,6 +46,10 @@ struct _aubio_beattracking_t
   fvec_t *dfrev;         /** reversed onset detection function */
   fvec_t *acf;           /** vector for autocorrelation function (of current detection function frame) */
   fvec_t *acfout;        /** store result of passing acf through s.i.c.f.b. */
+  aubio_fft_t *fft;      /** fft to compute acf, long enough for a linear correlation */
+  fvec_t *acfin;         /** zero padded detection function frame */
+  fvec_t *acfspec;       /** power spectrum of acfin */
+  fvec_t *acfres;        /** unbiased autocorrelation of acfin */
   fvec_t *phout;
   uint_t timesig;        /** time signature of input, set to zero until context dependent model activated */
   uint_t step;
@@ -87,6 +97,11 @@ new_aubio_beattracking (uint_t winlen, uint_t hop_size, uint_t samplerate)
   p->dfrev = new_fvec (winlen);
   p->acf = new_fvec (winlen);
   p->acfout = new_fvec (laglen);
+  /* twice the frame length, so that the circular correlation does not wrap */
+  p->fft = new_aubio_fft (aubio_next_power_of_two (2 * winlen - 1));
+  p->acfin = new_fvec (aubio_next_power_of_two (2 * winlen - 1));
+  p->acfspec = new_fvec (aubio_next_power_of_two (2 * winlen - 1));
+  p->acfres = new_fvec (aubio_next_power_of_two (2 * winlen - 1));
   p->phwv = new_fvec (2 * laglen);
   p->phout = new_fvec (winlen);
 
@@ -116,6 +131,11 @@ del_aubio_beattracking (aubio_beattracking_t * p)
   del_fvec (p->dfrev);
   del_fvec (p->acf);
   del_fvec (p->acfout);
+  if (p->fft)
+    del_aubio_fft (p->fft);
+  del_fvec (p->acfin);
+  del_fvec (p->acfspec);
+  del_fvec (p->acfres);
   del_fvec (p->phwv);
   del_fvec (p->phout);
   AUBIO_FREE (p);
@@ -129,7 +149,6 @@ aubio_beattracking_do (aubio_beattracking_t * bt, const fvec_t * dfframe,
 
   uint_t i, k;
   uint_t step = bt->step;
-  uint_t laglen = bt->rwv->length;
   uint_t winlen = bt->dfwv->length;
   uint_t maxindex = 0;
   //number of harmonics in shift invariant comb filterbank
@@ -138,7 +157,6 @@ aubio_beattracking_do (aubio_beattracking_t * bt, const fvec_t * dfframe,
   smpl_t phase;                 // beat alignment (step - lastbeat)
   smpl_t beat;                  // beat position
   smpl_t bp;                    // beat period
-  uint_t a, b;                  // used to build shift invariant comb filterbank
   uint_t kmax;                  // number of elements used to find beat phase
 
   /* copy dfframe, apply detection function weighting, and revert */
@@ -147,7 +165,7 @@ aubio_beattracking_do (aubio_beattracking_t * bt, const fvec_t * dfframe,
   fvec_rev (bt->dfrev);
 
   /* compute autocorrelation function */
-  aubio_autocorr (dfframe, bt->acf);
+  aubio_beattracking_autocorr (bt, dfframe);
 
   /* if timesig is unknown, use metrically unbiased version of filterbank */
   if (!bt->timesig) {
@@ -156,18 +174,8 @@ aubio_beattracking_do (aubio_beattracking_t * bt, const fvec_t * dfframe,
     numelem = bt->timesig;
   }
 
-  /* first and last output values are left intentionally as zero */
-  fvec_zeros (bt->acfout);
-
   /* compute shift invariant comb filterbank */
-  for (i = 1; i < laglen - 1; i++) {
-    for (a = 1; a <= numelem; a++) {
-      for (b = 1; b < 2 * a; b++) {
-        bt->acfout->data[i] += bt->acf->data[i * a + b - 1]
-            * 1. / (2. * a - 1.);
-      }
-    }
-  }
+  aubio_beattracking_combfb (bt->acf, bt->acfout, numelem, 1);
   /* apply Rayleigh weight */
   fvec_weight (bt->acfout, bt->rwv);
 
@@ -261,6 +269,59 @@ aubio_beattracking_do (aubio_beattracking_t * bt, const fvec_t * dfframe,
   output->data[0] = i;
 }
 
+/* same as aubio_autocorr (dfframe, bt->acf), through the power spectrum of
+ * the zero padded frame */
+static void
+aubio_beattracking_autocorr (aubio_beattracking_t * bt, const fvec_t * dfframe)
+{
+  uint_t i, length = dfframe->length, fftlen = bt->acfin->length;
+  smpl_t *spec = bt->acfspec->data;
+  if (!bt->fft) {
+    aubio_autocorr (dfframe, bt->acf);
+    return;
+  }
+  fvec_zeros (bt->acfin);
+  memcpy (bt->acfin->data, dfframe->data, length * sizeof (smpl_t));
+  aubio_fft_do_complex (bt->fft, bt->acfin, bt->acfspec);
+  /* squared norms in the real part, null imaginary part */
+  spec[0] = SQR (spec[0]);
+  spec[fftlen / 2] = SQR (spec[fftlen / 2]);
+  for (i = 1; i < fftlen / 2; i++) {
+    spec[i] = SQR (spec[i]) + SQR (spec[fftlen - i]);
+    spec[fftlen - i] = 0.;
+  }
+  aubio_fft_rdo_complex (bt->fft, bt->acfspec, bt->acfres);
+  for (i = 0; i < length; i++) {
+    bt->acf->data[i] = bt->acfres->data[i] / (smpl_t) (length - i);
+  }
+}
+
+/* shift invariant comb filterbank: output i sums the acf around its
+ * multiples a * i, for a from 1 to numelem, over 2a - 1 lags. Each row is a
+ * few contiguous runs of acf, summed before weighting by 1 / (2a - 1). The
+ * first and last output values are left intentionally as zero. */
+static void
+aubio_beattracking_combfb (const fvec_t * acf, fvec_t * acfout,
+    uint_t numelem, uint_t weighted)
+{
+  uint_t i, a, b;
+  uint_t laglen = acfout->length;
+  smpl_t scale, sum;
+  const smpl_t *run;
+  fvec_zeros (acfout);
+  for (a = 1; a <= numelem; a++) {
+    scale = weighted ? 1. / (2. * a - 1.) : 1.;
+    for (i = 1; i < laglen - 1; i++) {
+      run = acf->data + i * a;
+      sum = 0.;
+      for (b = 0; b < 2 * a - 1; b++) {
+        sum += run[b];
+      }
+      acfout->data[i] += scale * sum;
+    }
+  }
+}
+
 uint_t
 fvec_gettimesig (fvec_t * acf, uint_t acflen, uint_t gp)
 {
@@ -285,7 +346,7 @@ fvec_gettimesig (fvec_t * acf, uint_t acflen, uint_t gp)
 void
 aubio_beattracking_checkstate (aubio_beattracking_t * bt)
 {
-  uint_t i, j, a, b;
+  uint_t j;
   uint_t flagconst = 0;
   sint_t counter = bt->counter;
   uint_t flagstep = bt->flagstep;
@@ -302,14 +363,7 @@ aubio_beattracking_checkstate (aubio_beattracking_t * bt)
 
   if (gp) {
     // compute shift invariant comb filterbank
-    fvec_zeros (acfout);
-    for (i = 1; i < laglen - 1; i++) {
-      for (a = 1; a <= bt->timesig; a++) {
-        for (b = 1; b < 2 * a; b++) {
-          acfout->data[i] += acf->data[i * a + b - 1];
-        }
-      }
-    }
+    aubio_beattracking_combfb (acf, acfout, bt->timesig, 0);
     // since gp is set, gwv has been computed in previous checkstate
     fvec_weight (acfout, bt->gwv);
     gp = fvec_quadratic_peak_pos (acfout, fvec_max_elem (acfout));
@@ -53,15 +53,37 @@ struct _aubio_tempo_t {
   uint_t tatum_signature;        /** number of tatum between each beats */
 };
 
+/* run onset detection function and beat tracking on a spectral frame */
+static void aubio_tempo_detect (aubio_tempo_t *o, const fvec_t * input,
+    const cvec_t * fftgrain, fvec_t * tempo);
+
 /* execute tempo detection function on iput buffer */
 void aubio_tempo_do(aubio_tempo_t *o, const fvec_t * input, fvec_t * tempo)
+{
+  aubio_pvoc_do (o->pv, input, o->fftgrain);
+  aubio_tempo_detect (o, input, o->fftgrain, tempo);
+}
+
+uint_t aubio_tempo_do_spectrum (aubio_tempo_t *o, const fvec_t * input,
+    const cvec_t * spectrum, fvec_t * tempo)
+{
+  if (spectrum->length != o->fftgrain->length) {
+    AUBIO_ERR ("tempo: spectrum has %d bins, expected %d\n",
+        spectrum->length, o->fftgrain->length);
+    return AUBIO_FAIL;
+  }
+  aubio_tempo_detect (o, input, spectrum, tempo);
+  return AUBIO_OK;
+}
+
+static void aubio_tempo_detect (aubio_tempo_t *o, const fvec_t * input,
+    const cvec_t * fftgrain, fvec_t * tempo)
 {
   uint_t i;
   uint_t winlen = o->winlen;
   uint_t step   = o->step;
   fvec_t * thresholded;
-  aubio_pvoc_do (o->pv, input, o->fftgrain);
-  aubio_specdesc_do (o->od, o->fftgrain, o->of);
+  aubio_specdesc_do (o->od, fftgrain, o->of);
   /*if (usedoubled) {
     aubio_specdesc_do(o2,fftgrain, onset2);
     onset->data[0] *= onset2->data[0];
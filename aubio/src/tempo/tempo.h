@@ -62,6 +62,24 @@ aubio_tempo_t * new_aubio_tempo (const char_t * method,
 */
 void aubio_tempo_do (aubio_tempo_t *o, const fvec_t * input, fvec_t * tempo);
 
+/** execute tempo detection on a spectral frame computed by the caller
+
+  \param o beat tracking object
+  \param input new samples, only used to check for silence
+  \param spectrum spectral frame of the last [buf_size] samples, as computed
+  by aubio_pvoc_do() or a shared ::aubio_frontend_t with the same buffer and
+  hop sizes
+  \param tempo output beats
+
+  Same as aubio_tempo_do(), without computing the FFT of `input`. The spectrum
+  is not modified.
+
+  \return 0 if successful, non-zero if the spectrum size does not match
+
+*/
+uint_t aubio_tempo_do_spectrum (aubio_tempo_t *o, const fvec_t * input,
+    const cvec_t * spectrum, fvec_t * tempo);
+
 /** get the time of the latest beat detected, in samples
 
   \param o tempo detection object as returned by ::new_aubio_tempo
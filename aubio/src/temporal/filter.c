@@ -28,6 +28,11 @@
 #include "mathutils.h"
 #include "temporal/filter.h"
 
+/* relative tolerances of the roots at 1 and -1, and of the factorisation */
+#define AUBIO_FILTER_ROOT_TOL 1.e-12
+#define AUBIO_FILTER_SECTIONS_TOL 1.e-6
+#define AUBIO_FILTER_ROOT_ITER 500
+
 struct _aubio_filter_t
 {
   uint_t order;
@@ -36,8 +41,21 @@ struct _aubio_filter_t
   lvec_t *b;
   lvec_t *y;
   lvec_t *x;
+  /* cascade of second order sections, transposed direct form II */
+  uint_t nsections;      /**< number of sections, 0 to use the direct form */
+  lvec_t *sections;      /**< b0, b1, b2, a1, a2 of each section */
+  lvec_t *state;         /**< two delays per section */
+  lvec_t *coeffs;        /**< b and a the sections were computed from */
+  lvec_t *work;          /**< polynomial and roots, used while factoring */
 };
 
+static void aubio_filter_update_sections (aubio_filter_t * f);
+static uint_t aubio_filter_poly_roots (lsmp_t * poly, uint_t degree,
+    uint_t unit_roots, lsmp_t * re, lsmp_t * im);
+static uint_t aubio_filter_roots_to_sections (const lsmp_t * re,
+    const lsmp_t * im, uint_t degree, lsmp_t * out, lsmp_t * tmp);
+static void aubio_filter_do_direct (aubio_filter_t * f, fvec_t * in);
+
 void
 aubio_filter_do_outplace (aubio_filter_t * f, const fvec_t * in, fvec_t * out)
 {
@@ -47,6 +65,69 @@ aubio_filter_do_outplace (aubio_filter_t * f, const fvec_t * in, fvec_t * out)
 
 void
 aubio_filter_do (aubio_filter_t * f, fvec_t * in)
+{
+  uint_t j, l, n = f->nsections;
+  lsmp_t *c = f->sections->data;
+  lsmp_t *s = f->state->data;
+
+  /* coefficients can be written through the feedback and feedforward vectors */
+  if (memcmp (f->coeffs->data, f->b->data, f->order * sizeof(lsmp_t)) != 0
+      || memcmp (f->coeffs->data + f->order, f->a->data,
+        f->order * sizeof(lsmp_t)) != 0) {
+    aubio_filter_update_sections (f);
+    /* the delays are kept, as the direct form keeps its past samples, so
+     * that changing the coefficients does not click. They only belong to
+     * another structure when the number of sections changed */
+    if (f->nsections != n) {
+      aubio_filter_do_reset (f);
+    }
+    n = f->nsections;
+  }
+
+  if (n == 0) {
+    aubio_filter_do_direct (f, in);
+    return;
+  }
+
+  if (n == 1) {
+    /* single biquad, delays kept in registers */
+    lsmp_t b0 = c[0], b1 = c[1], b2 = c[2], a1 = c[3], a2 = c[4];
+    lsmp_t s1 = s[0], s2 = s[1];
+    for (j = 0; j < in->length; j++) {
+      lsmp_t x = in->data[j];
+      lsmp_t y = b0 * x + s1;
+      s1 = b1 * x - a1 * y + s2;
+      s2 = b2 * x - a2 * y;
+      in->data[j] = y;
+    }
+    s[0] = s1;
+    s[1] = s2;
+  } else {
+    for (j = 0; j < in->length; j++) {
+      lsmp_t y = in->data[j];
+      for (l = 0; l < n; l++) {
+        const lsmp_t *cl = c + 5 * l;
+        lsmp_t *sl = s + 2 * l;
+        lsmp_t x = y;
+        y = cl[0] * x + sl[0];
+        sl[0] = cl[1] * x - cl[3] * y + sl[1];
+        sl[1] = cl[2] * x - cl[4] * y;
+      }
+      in->data[j] = y;
+    }
+  }
+
+  /* flush decaying delays once per block rather than the input of each sample */
+  for (l = 0; l < 2 * n; l++) {
+    if (fabs (s[l]) < VERY_SMALL_NUMBER) {
+      s[l] = 0.;
+    }
+  }
+}
+
+/* the generic direct form, used when the filter could not be factored */
+static void
+aubio_filter_do_direct (aubio_filter_t * f, fvec_t * in)
 {
   uint_t j, l, order = f->order;
   lsmp_t *x = f->x->data;
@@ -128,6 +209,307 @@ aubio_filter_do_reset (aubio_filter_t * f)
 {
   lvec_zeros (f->x);
   lvec_zeros (f->y);
+  lvec_zeros (f->state);
+}
+
+/* split the filter in second order sections, each pole pair with its
+ * nearest zero pair, or leave nsections to 0 if that fails */
+static void
+aubio_filter_update_sections (aubio_filter_t * f)
+{
+  uint_t i, j, k, order = f->order, degree = order - 1;
+  uint_t n = order / 2;
+  lsmp_t *c = f->sections->data;
+  lsmp_t *w = f->work->data;
+  lsmp_t *zre = w, *zim = w + order, *pre = w + 2 * order, *pim = w + 3 * order;
+  lsmp_t *poly = w + 4 * order, *tmp = w + 5 * order;
+  lsmp_t *zeros = w + 7 * order, *poles = zeros + 3 * n;
+  lsmp_t gain = f->b->data[0], err = 0., norm = 0.;
+
+  memcpy (f->coeffs->data, f->b->data, order * sizeof(lsmp_t));
+  memcpy (f->coeffs->data + order, f->a->data, order * sizeof(lsmp_t));
+  f->nsections = 0;
+
+  if (degree <= 2) {
+    /* already a biquad, or less */
+    lvec_zeros (f->sections);
+    for (i = 0; i < order; i++) {
+      c[i] = f->b->data[i];
+      if (i > 0) {
+        c[2 + i] = f->a->data[i];
+      }
+    }
+    f->nsections = 1;
+    return;
+  }
+
+  if (gain == 0.) {
+    return;
+  }
+
+  /* b / b[0] and a, a[0] being implicitly 1 as in the direct form */
+  for (i = 0; i < order; i++) {
+    poly[i] = f->b->data[i] / gain;
+  }
+  if (aubio_filter_poly_roots (poly, degree, 1, zre, zim) != AUBIO_OK) {
+    return;
+  }
+  poly[0] = 1.;
+  for (i = 1; i < order; i++) {
+    poly[i] = f->a->data[i];
+  }
+  /* poles close to 1 are common, and must not be moved onto the circle */
+  if (aubio_filter_poly_roots (poly, degree, 0, pre, pim) != AUBIO_OK) {
+    return;
+  }
+  if (aubio_filter_roots_to_sections (zre, zim, degree, zeros, tmp) != AUBIO_OK
+      || aubio_filter_roots_to_sections (pre, pim, degree, poles, tmp)
+      != AUBIO_OK) {
+    return;
+  }
+
+  /* pair each pole section with the closest unused zero section, measured
+   * on their coefficients, which keeps the gain of each section moderate */
+  for (i = 0; i < n; i++) {
+    lsmp_t best = 0.;
+    uint_t pick = n;
+    for (j = 0; j < n; j++) {
+      lsmp_t d;
+      if (zeros[3 * j] == 0.) continue;
+      d = fabs(zeros[3 * j + 1] - poles[3 * i + 1])
+        + fabs(zeros[3 * j + 2] - poles[3 * i + 2]);
+      if (pick == n || d < best) {
+        best = d;
+        pick = j;
+      }
+    }
+    c[5 * i + 0] = zeros[3 * pick];
+    c[5 * i + 1] = zeros[3 * pick + 1];
+    c[5 * i + 2] = zeros[3 * pick + 2];
+    c[5 * i + 3] = poles[3 * i + 1];
+    c[5 * i + 4] = poles[3 * i + 2];
+    /* mark as used */
+    zeros[3 * pick] = 0.;
+  }
+  c[0] *= gain;
+  c[1] *= gain;
+  c[2] *= gain;
+
+  /* multiply the sections back and compare with the original filter */
+  for (k = 0; k < 2; k++) {
+    const lsmp_t *orig = k == 0 ? f->b->data : f->a->data;
+    for (i = 0; i < order; i++) {
+      poly[i] = i == 0 ? 1. : 0.;
+    }
+    for (j = 0; j < n; j++) {
+      const lsmp_t *cj = c + 5 * j + (k == 0 ? 0 : 2);
+      lsmp_t c0 = k == 0 ? cj[0] : 1.;
+      lsmp_t c1 = cj[1], c2 = cj[2];
+      for (i = order; i-- > 0;) {
+        lsmp_t v = c0 * poly[i];
+        if (i >= 1) v += c1 * poly[i - 1];
+        if (i >= 2) v += c2 * poly[i - 2];
+        poly[i] = v;
+      }
+    }
+    for (i = 0; i < order; i++) {
+      lsmp_t expected = (k == 1 && i == 0) ? 1. : orig[i];
+      err += fabs(poly[i] - expected);
+      norm += fabs(expected);
+    }
+  }
+  if (err > AUBIO_FILTER_SECTIONS_TOL * norm) {
+    return;
+  }
+  f->nsections = n;
+}
+
+/* roots of the monic polynomial poly[0] z^d + ... + poly[d], overwritten.
+ * roots at 0, and at 1 and -1 if unit_roots is set, are common in audio
+ * filters and poorly resolved when repeated, so they are divided out first;
+ * the others are found with Durand-Kerner */
+static uint_t
+aubio_filter_poly_roots (lsmp_t * poly, uint_t degree, uint_t unit_roots,
+    lsmp_t * re, lsmp_t * im)
+{
+  uint_t i, j, it, found = 0, d = degree;
+  lsmp_t norm = 0.;
+
+  for (i = 0; i <= degree; i++) {
+    norm += fabs(poly[i]);
+  }
+
+  while (d > 0) {
+    lsmp_t r, q;
+    uint_t k;
+    if (poly[d] == 0.) {
+      r = 0.;
+    } else if (!unit_roots) {
+      break;
+    } else {
+      /* value of the polynomial at 1 and -1 */
+      lsmp_t p1 = 0., m1 = 0., sign = 1.;
+      for (k = d + 1; k-- > 0;) {
+        p1 += poly[k];
+        m1 += sign * poly[k];
+        sign = -sign;
+      }
+      if (fabs(p1) <= AUBIO_FILTER_ROOT_TOL * norm) {
+        r = 1.;
+      } else if (fabs(m1) <= AUBIO_FILTER_ROOT_TOL * norm) {
+        r = -1.;
+      } else {
+        break;
+      }
+    }
+    /* synthetic division by (z - r), the remainder is dropped */
+    q = 0.;
+    for (k = 0; k <= d; k++) {
+      q = poly[k] + r * q;
+      poly[k] = q;
+    }
+    re[found] = r;
+    im[found] = 0.;
+    found++;
+    d--;
+  }
+
+  if (d == 0) {
+    return AUBIO_OK;
+  }
+
+  /* Durand-Kerner on the remaining degree d polynomial */
+  for (i = 0; i < d; i++) {
+    /* powers of 0.4 + 0.9i, neither real nor on a circle of symmetry */
+    lsmp_t r = 1., s = 0.;
+    for (j = 0; j <= i; j++) {
+      lsmp_t t = r * .4 - s * .9;
+      s = r * .9 + s * .4;
+      r = t;
+    }
+    re[found + i] = r;
+    im[found + i] = s;
+  }
+  /* poles close to 1 are badly conditioned, the polynomial is evaluated with
+   * extra precision where available */
+  for (it = 0; it < AUBIO_FILTER_ROOT_ITER; it++) {
+    lsmp_t moved = 0.;
+    for (i = found; i < found + d; i++) {
+      long double zr = re[i], zi = im[i];
+      long double pr = poly[0], pi = 0., qr = 1., qi = 0., den, t;
+      /* value at z with Horner's rule */
+      for (j = 1; j <= d; j++) {
+        t = pr * zr - pi * zi + poly[j];
+        pi = pr * zi + pi * zr;
+        pr = t;
+      }
+      /* product of the distances to the other roots */
+      for (j = found; j < found + d; j++) {
+        long double dr, di;
+        if (j == i) continue;
+        dr = zr - re[j];
+        di = zi - im[j];
+        t = qr * dr - qi * di;
+        qi = qr * di + qi * dr;
+        qr = t;
+      }
+      den = qr * qr + qi * qi;
+      if (den == 0.) {
+        return AUBIO_FAIL;
+      }
+      t = (pr * qr + pi * qi) / den;
+      pi = (pi * qr - pr * qi) / den;
+      re[i] = zr - t;
+      im[i] = zi - pi;
+      moved = MAX(moved, fabsl(t) + fabsl(pi));
+    }
+    if (moved < 1.e-15) {
+      break;
+    }
+  }
+  return AUBIO_OK;
+}
+
+/* group roots in real second order polynomials 1, c1, c2: complex roots with
+ * the root closest to their conjugate, real roots by two, largest first.
+ * writes one triplet per section to out, using 2 * degree elements of tmp */
+static uint_t
+aubio_filter_roots_to_sections (const lsmp_t * re, const lsmp_t * im,
+    uint_t degree, lsmp_t * out, lsmp_t * tmp)
+{
+  uint_t i, j, n = 0, nreal = 0, nleft = degree;
+  lsmp_t *r = tmp, *x = tmp + degree, *real = x;
+  lsmp_t tol = 1.e-7;
+
+  memcpy (r, re, degree * sizeof(lsmp_t));
+  memcpy (x, im, degree * sizeof(lsmp_t));
+
+  while (nleft > 0) {
+    lsmp_t *o, best = 0.;
+    uint_t k = 0, pick;
+    /* most complex root left */
+    for (i = 1; i < nleft; i++) {
+      if (fabs(x[i]) > fabs(x[k])) k = i;
+    }
+    if (fabs(x[k]) <= tol * MAX(1., fabs(r[k]))) {
+      break;
+    }
+    if (nleft < 2) {
+      return AUBIO_FAIL;
+    }
+    pick = k;
+    for (i = 0; i < nleft; i++) {
+      lsmp_t d;
+      if (i == k) continue;
+      d = fabs(r[i] - r[k]) + fabs(x[i] + x[k]);
+      if (pick == k || d < best) {
+        best = d;
+        pick = i;
+      }
+    }
+    if (best > 1.e-3 * MAX(1., fabs(r[k]) + fabs(x[k]))) {
+      return AUBIO_FAIL;
+    }
+    o = out + 3 * n++;
+    o[0] = 1.;
+    o[1] = -(r[k] + r[pick]);
+    o[2] = r[k] * r[pick] - x[k] * x[pick];
+    /* remove both roots, the last ones taking their place */
+    j = MAX(k, pick);
+    r[j] = r[nleft - 1];
+    x[j] = x[nleft - 1];
+    nleft--;
+    j = MIN(k, pick);
+    r[j] = r[nleft - 1];
+    x[j] = x[nleft - 1];
+    nleft--;
+  }
+
+  /* the remaining roots are real, sort them by decreasing value so that
+   * close ones are paired */
+  nreal = nleft;
+  for (i = 0; i < nreal; i++) {
+    real[i] = r[i];
+  }
+  for (i = 1; i < nreal; i++) {
+    for (j = i; j > 0 && real[j] > real[j - 1]; j--) {
+      lsmp_t t = real[j];
+      real[j] = real[j - 1];
+      real[j - 1] = t;
+    }
+  }
+  for (i = 0; i < nreal; i += 2) {
+    lsmp_t *o = out + 3 * n++;
+    o[0] = 1.;
+    if (i + 1 < nreal) {
+      o[1] = -(real[i] + real[i + 1]);
+      o[2] = real[i] * real[i + 1];
+    } else {
+      o[1] = -real[i];
+      o[2] = 0.;
+    }
+  }
+  return AUBIO_OK;
 }
 
 aubio_filter_t *
@@ -142,12 +524,17 @@ new_aubio_filter (uint_t order)
   f->y = new_lvec (order);
   f->a = new_lvec (order);
   f->b = new_lvec (order);
+  f->sections = new_lvec (5 * (order / 2 + 1));
+  f->state = new_lvec (2 * (order / 2 + 1));
+  f->coeffs = new_lvec (2 * order);
+  f->work = new_lvec (7 * order + 6 * (order / 2 + 1));
   /* by default, samplerate is not set */
   f->samplerate = 0;
   f->order = order;
   /* set default to identity */
   f->a->data[0] = 1.;
   f->b->data[0] = 1.;
+  aubio_filter_update_sections (f);
   return f;
 }
 
@@ -158,6 +545,10 @@ del_aubio_filter (aubio_filter_t * f)
   del_lvec (f->b);
   del_lvec (f->x);
   del_lvec (f->y);
+  del_lvec (f->sections);
+  del_lvec (f->state);
+  del_lvec (f->coeffs);
+  del_lvec (f->work);
   AUBIO_FREE (f);
   return;
 }
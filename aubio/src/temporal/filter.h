@@ -53,6 +53,16 @@
   forward then backward, to compensate with the phase shifting of the forward
   operation.
 
+  Internally, the filter is factored in a cascade of second order sections,
+  each run in transposed direct form II, which is faster and numerically
+  safer than the equation above for high orders. The factorisation is done
+  again on the next call after the coefficients changed. The filter memory is
+  kept, unless the new coefficients factor in a different number of sections.
+  Filters that can not be factored accurately are run as written.
+
+  The coefficients are read by the filtering functions, and should be changed
+  from the thread running them.
+
   Some convenience functions are provided:
     - new_aubio_filter_a_weighting() and aubio_filter_set_a_weighting(),
     - new_aubio_filter_c_weighting() and aubio_filter_set_c_weighting().
@@ -0,0 +1,188 @@
+/*
+ * DISTRHO PitchTracking Series
+ * Copyright (C) 2021-2022 Bram Giesen
+ * Copyright (C) 2022 Filipe Coelho <falktx@falktx.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 3 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * For a full copy of the GNU General Public License see the LICENSE file.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+extern "C" {
+#include <aubio.h>
+}
+
+// -----------------------------------------------------------------------
+// Detector setup shared by the plugins and the offline tools
+
+// aubio setup values (tested under 48 kHz sample rate)
+static constexpr const uint32_t kAubioHopSize = 1;
+static constexpr const uint32_t kAubioBufferSize = (1024 + 256 + 128) / kAubioHopSize;
+static constexpr const char* const kAubioMethod = "yinfast";
+static constexpr const float kAubioSilence = -30.0f;
+
+// onset detection used by the CV plugin to analyse note attacks early
+static constexpr const uint32_t kAubioOnsetHopSize = 128;
+static constexpr const uint32_t kAubioOnsetBufferSize = 512;
+
+// beat tracking of the CV plugin, fed with one out of every few spectra of the onset analysis,
+// at the hop size the aubio beat tracking was tuned for
+static constexpr const uint32_t kAubioTempoHopSize = 512;
+static constexpr const uint32_t kAubioTempoBufferSize = kAubioOnsetBufferSize;
+
+// beat trigger length and tempo CV scale of the CV plugin, 120 BPM is 4V
+static constexpr const float kBeatTriggerSeconds = 0.01f;
+static constexpr const float kTempoBPMPerVolt = 30.f;
+
+// shorter windows analysed after an onset, while the full buffer is not yet available
+static constexpr const uint32_t kAubioEarlyBufferSizes[] = { 512, 1024 };
+static constexpr const uint32_t kAubioEarlyBufferCount = sizeof(kAubioEarlyBufferSizes)/sizeof(kAubioEarlyBufferSizes[0]);
+
+// shorter windows used by the CV plugin while a stable pitch is tracked, fitting a few of its periods
+static constexpr const uint32_t kAubioAdaptiveBufferSizes[] = { 256, 512, 1024 };
+static constexpr const uint32_t kAubioAdaptiveBufferCount = sizeof(kAubioAdaptiveBufferSizes)/sizeof(kAubioAdaptiveBufferSizes[0]);
+
+// fewest periods a shorter window is sized for, yinfast only finds periods below half of its window
+static constexpr const int kAubioAdaptiveMinPeriods = 3;
+
+// confident frames within this many cents of each other before the window shrinks
+static constexpr const uint32_t kAubioAdaptiveStableFrames = 3;
+static constexpr const float kAubioAdaptiveStableCents = 50.f;
+
+// band-limiting filters of the CV plugin input, high-pass an octave below the lowest pitch and
+// low-pass two octaves above the highest one, keeping the first harmonics YIN relies on
+static constexpr const uint32_t kPreFilterBlockSize = 256;
+static constexpr const float kPreFilterHighPassRatio = 0.5f;
+static constexpr const float kPreFilterLowPassRatio = 4.f;
+// largest change of the pre-filter cutoffs from one block to the next while they are automated, a quarter octave
+static constexpr const float kPreFilterMaxStepRatio = 1.189207f;
+
+// aubio notes setup values, used by the MIDI plugin (tested under 48 kHz sample rate)
+// the notes object analyses pitch over 4 times the buffer size
+static constexpr const uint32_t kAubioNotesHopSize = 256;
+static constexpr const uint32_t kAubioNotesBufferSize = 512;
+
+// default values
+static constexpr const float kDefaultSensitivity = 50.f;
+static constexpr const float kDefaultTolerance = 6.25f;
+static constexpr const float kDefaultThreshold = 12.5f;
+static constexpr const int kDefaultOctave = 0;
+static constexpr const bool kDefaultHoldOutputPitch = false;
+static constexpr const bool kDefaultFastAttack = false;
+static constexpr const int kDefaultWindowPeriods = 0;
+static constexpr const bool kDefaultPreFilter = false;
+static constexpr const float kDefaultLowestPitch = 40.f;
+static constexpr const float kDefaultHighestPitch = 1400.f;
+static constexpr const bool kDefaultBeatTracking = false;
+static constexpr const bool kDefaultTimbreOutputs = false;
+static constexpr const float kDefaultNotesSilence = -70.f;
+static constexpr const float kDefaultNotesReleaseDrop = 10.f;
+static constexpr const float kDefaultNotesMinInterval = 30.f;
+static constexpr const float kDefaultNotesEarlyConfidence = 60.f;
+
+// static checks
+static_assert(sizeof(smpl_t) == sizeof(float), "smpl_t is float");
+static_assert(kAubioBufferSize % kAubioHopSize == 0, "kAubioBufferSize / kAubioHopSize has no remainder");
+static_assert(kAubioTempoHopSize % kAubioOnsetHopSize == 0, "tempo hops are a whole number of onset hops");
+static_assert(kAubioTempoHopSize <= kAubioBufferSize, "the onset history holds a whole tempo hop");
+static_assert(kAubioEarlyBufferSizes[kAubioEarlyBufferCount - 1] < kAubioBufferSize, "early buffers are shorter than the full buffer");
+static_assert(kAubioAdaptiveBufferSizes[kAubioAdaptiveBufferCount - 1] < kAubioBufferSize, "adaptive buffers are shorter than the full buffer");
+
+// -----------------------------------------------------------------------
+
+// create a pitch detector the same way the plugins do, tolerance is in 0-1 range
+static inline
+aubio_pitch_t* createAubioPitchDetector(const double sampleRate, const float tolerance)
+{
+    aubio_pitch_t* const pitchDetector = new_aubio_pitch(kAubioMethod, kAubioBufferSize, kAubioHopSize, sampleRate);
+
+    if (pitchDetector == nullptr)
+        return nullptr;
+
+    aubio_pitch_set_silence(pitchDetector, kAubioSilence);
+    aubio_pitch_set_tolerance(pitchDetector, tolerance);
+    aubio_pitch_set_unit(pitchDetector, "Hz");
+    return pitchDetector;
+}
+
+// create a notes detector the same way the MIDI plugin does, early confidence is in 0-1 range
+static inline
+aubio_notes_t* createAubioNotesDetector(const double sampleRate, const float silence,
+                                        const float releaseDrop, const float minInterval,
+                                        const float earlyConfidence)
+{
+    aubio_notes_t* const notesDetector = new_aubio_notes("default", kAubioNotesBufferSize, kAubioNotesHopSize, sampleRate);
+
+    if (notesDetector == nullptr)
+        return nullptr;
+
+    aubio_notes_set_silence(notesDetector, silence);
+    aubio_notes_set_release_drop(notesDetector, releaseDrop);
+    aubio_notes_set_minioi_ms(notesDetector, minInterval);
+    aubio_notes_set_early_confidence(notesDetector, earlyConfidence);
+    return notesDetector;
+}
+
+// create an onset detector for the early attack analysis of the CV plugin
+static inline
+aubio_onset_t* createAubioOnsetDetector(const double sampleRate)
+{
+    aubio_onset_t* const onsetDetector = new_aubio_onset("default", kAubioOnsetBufferSize, kAubioOnsetHopSize, sampleRate);
+
+    if (onsetDetector == nullptr)
+        return nullptr;
+
+    aubio_onset_set_silence(onsetDetector, kAubioSilence);
+    return onsetDetector;
+}
+
+// create a beat tracker for the CV plugin, its spectra come from the onset analysis
+static inline
+aubio_tempo_t* createAubioTempoDetector(const double sampleRate)
+{
+    aubio_tempo_t* const tempoDetector = new_aubio_tempo("default", kAubioTempoBufferSize, kAubioTempoHopSize, sampleRate);
+
+    if (tempoDetector == nullptr)
+        return nullptr;
+
+    aubio_tempo_set_silence(tempoDetector, kAubioSilence);
+    return tempoDetector;
+}
+
+// set a 2nd order butterworth high-pass or low-pass on an order 3 filter, cutoff is clamped below nyquist
+static inline
+bool setAubioPreFilter(aubio_filter_t* const filter, const double sampleRate, const float cutoff, const bool highPass)
+{
+    const double w0 = 2.0 * M_PI * std::min(static_cast<double>(cutoff), 0.45 * sampleRate) / sampleRate;
+    const double cosw0 = std::cos(w0);
+    const double alpha = std::sin(w0) / std::sqrt(2.0);
+    const double a0 = 1.0 + alpha;
+    const double b0 = (highPass ? 1.0 + cosw0 : 1.0 - cosw0) * 0.5 / a0;
+    const double b1 = (highPass ? -2.0 : 2.0) * b0;
+
+    return aubio_filter_set_biquad(filter, b0, b1, b0, -2.0 * cosw0 / a0, (1.0 - alpha) / a0) == 0;
+}
+
+// convert a detected pitch to 1V/Oct CV, clamped to 0-10V
+static inline
+float pitchInHzToCV(const float pitchInHz, const int octave)
+{
+    const float linearPitch = 12.f * (log2f(pitchInHz / 440.f) + octave - 1) + 69.f;
+    return std::max(0.f, std::min(10.f, linearPitch * (1.f/12.f)));
+}
+
+// -----------------------------------------------------------------------
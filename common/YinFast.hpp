@@ -0,0 +1,343 @@
+/*
+ * DISTRHO PitchTracking Series
+ * Copyright (C) 2022 Filipe Coelho <falktx@falktx.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 3 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * For a full copy of the GNU General Public License see the LICENSE file.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+
+// -----------------------------------------------------------------------
+// The aubio yinfast pitch detector, specialized for a window size known at compile time.
+// All storage lives inside the object and loop bounds are constants, so nothing is allocated
+// and the compiler is free to unroll and vectorize. Results match aubio_pitchyinfast_do().
+
+static constexpr uint32_t yinFastNextPowerOfTwo(const uint32_t n, const uint32_t p = 1)
+{
+    return p >= n ? p : yinFastNextPowerOfTwo(n, p * 2);
+}
+
+// radix-2 complex FFT of a compile-time size, unscaled in both directions
+template <uint32_t M>
+class FixedFFT
+{
+    static_assert(M >= 4 && (M & (M - 1)) == 0, "FFT size is a power of 2");
+
+    // twiddles of the stage combining halves of size h start at index h, so each stage reads them in order
+    std::array<float, M> twiddleRe;
+    std::array<float, M> twiddleIm;
+    std::array<uint32_t, M> bitReversed;
+
+public:
+    FixedFFT() noexcept
+    {
+        twiddleRe[0] = twiddleIm[0] = 0.f;
+
+        for (uint32_t half = 1; half < M; half *= 2)
+        {
+            for (uint32_t k = 0; k < half; ++k)
+            {
+                const double phase = M_PI * k / half;
+                twiddleRe[half + k] = static_cast<float>(std::cos(phase));
+                twiddleIm[half + k] = static_cast<float>(-std::sin(phase));
+            }
+        }
+
+        for (uint32_t i = 0, j = 0; i < M; ++i)
+        {
+            bitReversed[i] = j;
+
+            uint32_t bit = M / 2;
+            for (; j & bit; bit /= 2)
+                j ^= bit;
+            j |= bit;
+        }
+    }
+
+    template <bool inverse>
+    void transform(float* const re, float* const im) const noexcept
+    {
+        for (uint32_t i = 0; i < M; ++i)
+        {
+            const uint32_t j = bitReversed[i];
+
+            if (i < j)
+            {
+                std::swap(re[i], re[j]);
+                std::swap(im[i], im[j]);
+            }
+        }
+
+        // first two stages at once, their twiddles are 1 and -i (or i for the inverse)
+        for (uint32_t s = 0; s < M; s += 4)
+        {
+            const float a0r = re[s] + re[s + 1], a0i = im[s] + im[s + 1];
+            const float a1r = re[s] - re[s + 1], a1i = im[s] - im[s + 1];
+            const float a2r = re[s + 2] + re[s + 3], a2i = im[s + 2] + im[s + 3];
+            const float a3r = re[s + 2] - re[s + 3], a3i = im[s + 2] - im[s + 3];
+            const float tr = inverse ? -a3i : a3i;
+            const float ti = inverse ? a3r : -a3r;
+            re[s] = a0r + a2r;
+            im[s] = a0i + a2i;
+            re[s + 2] = a0r - a2r;
+            im[s + 2] = a0i - a2i;
+            re[s + 1] = a1r + tr;
+            im[s + 1] = a1i + ti;
+            re[s + 3] = a1r - tr;
+            im[s + 3] = a1i - ti;
+        }
+
+        for (uint32_t half = 4; half < M; half *= 2)
+        {
+            const float* const wr = twiddleRe.data() + half;
+            const float* const wi = twiddleIm.data() + half;
+
+            for (uint32_t start = 0; start < M; start += 2 * half)
+            {
+                float* const ar = re + start;
+                float* const ai = im + start;
+                float* const br = ar + half;
+                float* const bi = ai + half;
+
+                for (uint32_t k = 0; k < half; ++k)
+                {
+                    const float s = inverse ? -wi[k] : wi[k];
+                    const float tr = br[k] * wr[k] - bi[k] * s;
+                    const float ti = br[k] * s + bi[k] * wr[k];
+                    br[k] = ar[k] - tr;
+                    bi[k] = ai[k] - ti;
+                    ar[k] += tr;
+                    ai[k] += ti;
+                }
+            }
+        }
+    }
+};
+
+// N is the window size, Hop the number of new samples given to each process() call
+template <uint32_t N, uint32_t Hop = N>
+class YinFast
+{
+    static_assert(N >= 8, "window holds a few lags");
+    static_assert(Hop >= 1 && Hop <= N, "hop size is within the window");
+
+public:
+    static constexpr const uint32_t kBufferSize = N;
+    static constexpr const uint32_t kHopSize = Hop;
+    static constexpr const uint32_t kYinSize = N / 2;
+    // the correlation is linear as long as the transform covers the window, so any size above works
+    static constexpr const uint32_t kFFTSize = yinFastNextPowerOfTwo(N);
+
+    YinFast() noexcept
+    {
+        for (uint32_t k = 0; k < M / 2; ++k)
+        {
+            const double phase = 2.0 * M_PI * k / M;
+            unpackRe[k] = static_cast<float>(std::cos(phase));
+            unpackIm[k] = static_cast<float>(std::sin(phase));
+        }
+
+        reset();
+    }
+
+    // clear the analysis window, only needed when the hop is shorter than the window
+    void reset() noexcept
+    {
+        buffer.fill(0.f);
+        yin.fill(1.f);
+        peakPos = 0;
+    }
+
+    void setTolerance(const float newTolerance) noexcept
+    {
+        tolerance = newTolerance;
+    }
+
+    float getTolerance() const noexcept
+    {
+        return tolerance;
+    }
+
+    // silence threshold in dB, windows below it give no period
+    void setSilence(const float newSilence) noexcept
+    {
+        silence = newSilence;
+    }
+
+    float getSilence() const noexcept
+    {
+        return silence;
+    }
+
+    float getConfidence() const noexcept
+    {
+        return 1.f - yin[peakPos];
+    }
+
+    // analyse Hop new samples, returns the period of the window in samples, or 0 if it is silent
+    float process(const float* const input) noexcept
+    {
+        const float* window;
+
+        if (Hop == N)
+        {
+            window = input;
+        }
+        else
+        {
+            std::copy(buffer.begin() + Hop, buffer.end(), buffer.begin());
+            std::copy(input, input + Hop, buffer.end() - Hop);
+            window = buffer.data();
+        }
+
+        const float period = analyse(window);
+
+        float energy = 0.f;
+        for (uint32_t i = 0; i < N; ++i)
+            energy += window[i] * window[i];
+
+        // same as aubio_silence_detection()
+        return 10.f * std::log10(energy / N) < silence ? 0.f : period;
+    }
+
+private:
+    static constexpr const uint32_t W = kYinSize;
+    static constexpr const uint32_t M = kFFTSize;
+
+    std::array<float, Hop == N ? 1 : N> buffer;
+    std::array<float, W> yin;
+    std::array<float, W> sqdiff;
+    std::array<float, M> re, im;
+    std::array<float, M / 2> productRe, productIm;
+    std::array<float, M / 2> unpackRe, unpackIm;
+    FixedFFT<M> fft;
+    FixedFFT<M / 2> ifft;
+
+    float tolerance = 0.15f;
+    float silence = -90.f;
+    uint32_t peakPos = 0;
+
+    float analyse(const float* const x) noexcept
+    {
+        // r_t(0) + r_t+tau(0), the energy of the first half plus a sliding one
+        float energy = 0.f;
+        for (uint32_t i = 0; i < W; ++i)
+            energy += x[i] * x[i];
+
+        sqdiff[0] = energy;
+        for (uint32_t tau = 1; tau < W; ++tau)
+            sqdiff[tau] = sqdiff[tau - 1] - x[tau - 1] * x[tau - 1] + x[W + tau - 1] * x[W + tau - 1];
+
+        // r_t(tau), correlating the first half with the whole window, both transformed at once:
+        // the first half as the real part and the window as the imaginary part
+        for (uint32_t i = 0; i < W; ++i)
+        {
+            re[i] = x[i];
+            im[i] = x[i];
+        }
+        for (uint32_t i = W; i < N; ++i)
+        {
+            re[i] = 0.f;
+            im[i] = x[i];
+        }
+        for (uint32_t i = N; i < M; ++i)
+        {
+            re[i] = 0.f;
+            im[i] = 0.f;
+        }
+
+        fft.template transform<false>(re.data(), im.data());
+
+        // split both spectra, A = (Z[f] + conj Z[-f]) / 2 and B = (Z[f] - conj Z[-f]) / 2i,
+        // and multiply conj(A) by B. The correlation is real, so its even samples go in the real part
+        // and its odd samples in the imaginary part of a half size inverse, which takes
+        // P[f] + P[f + M/2] + i e^(2 pi i f / M) (P[f] - P[f + M/2])
+        for (uint32_t f = 0; f < M / 2; ++f)
+        {
+            float pRe[2], pIm[2];
+
+            for (uint32_t h = 0; h < 2; ++h)
+            {
+                const uint32_t k = f + h * M / 2;
+                const uint32_t g = (M - k) & (M - 1);
+                const float aRe = 0.5f * (re[k] + re[g]);
+                const float aIm = 0.5f * (im[k] - im[g]);
+                const float bRe = 0.5f * (im[k] + im[g]);
+                const float bIm = 0.5f * (re[g] - re[k]);
+                pRe[h] = aRe * bRe + aIm * bIm;
+                pIm[h] = aRe * bIm - aIm * bRe;
+            }
+
+            const float dRe = pRe[0] - pRe[1];
+            const float dIm = pIm[0] - pIm[1];
+            productRe[f] = pRe[0] + pRe[1] - (unpackRe[f] * dIm + unpackIm[f] * dRe);
+            productIm[f] = pIm[0] + pIm[1] + (unpackRe[f] * dRe - unpackIm[f] * dIm);
+        }
+
+        ifft.template transform<true>(productRe.data(), productIm.data());
+
+        // square difference function, then its cumulative mean normalized version
+        constexpr const float scale = 2.f / M;
+        for (uint32_t tau = 0; tau < W; ++tau)
+        {
+            const float product = tau & 1 ? productIm[tau / 2] : productRe[tau / 2];
+            yin[tau] = energy + sqdiff[tau] - scale * product;
+        }
+
+        float sum = 0.f;
+        yin[0] = 1.f;
+
+        for (uint32_t tau = 1; tau < W; ++tau)
+        {
+            sum += yin[tau];
+            yin[tau] = sum != 0.f ? yin[tau] * tau / sum : 1.f;
+
+            // first dip below the tolerance
+            const uint32_t period = tau - 3;
+            if (tau > 4 && yin[period] < tolerance && yin[period] < yin[period + 1])
+            {
+                peakPos = period;
+                return quadraticPeakPos(period);
+            }
+        }
+
+        // otherwise the global minimum, the last one on ties like fvec_min_elem()
+        peakPos = 0;
+        for (uint32_t tau = 1; tau < W; ++tau)
+        {
+            if (yin[tau] <= yin[peakPos])
+                peakPos = tau;
+        }
+
+        return quadraticPeakPos(peakPos);
+    }
+
+    // same as fvec_quadratic_peak_pos()
+    float quadraticPeakPos(const uint32_t pos) const noexcept
+    {
+        if (pos == 0 || pos == W - 1)
+            return pos;
+
+        const float s0 = yin[pos - 1];
+        const float s1 = yin[pos];
+        const float s2 = yin[pos + 1];
+        return pos + 0.5f * (s0 - s2) / (s0 - 2.f * s1 + s2);
+    }
+};
+
+// -----------------------------------------------------------------------
@@ -17,32 +17,16 @@
  */
 
 #include "DistrhoPlugin.hpp"
+#include "PitchTracking.hpp"
+#include "YinFast.hpp"
 
-extern "C" {
-#include <aubio.h>
-}
+// not part of the stable aubio API
+#include "spectral/frontend.h"
 
 START_NAMESPACE_DISTRHO
 
 // -----------------------------------------------------------------------
 
-// aubio setup values (tested under 48 kHz sample rate)
-static constexpr const uint32_t kAubioHopSize = 1;
-static constexpr const uint32_t kAubioBufferSize = (1024 + 256 + 128) / kAubioHopSize;
-
-// default values
-static constexpr const float kDefaultSensitivity = 50.f;
-static constexpr const float kDefaultTolerance = 6.25f;
-static constexpr const float kDefaultThreshold = 12.5f;
-static constexpr const int kDefaultOctave = 0;
-static constexpr const bool kDefaultHoldOutputPitch = false;
-
-// static checks
-static_assert(sizeof(smpl_t) == sizeof(float), "smpl_t is float");
-static_assert(kAubioBufferSize % kAubioHopSize == 0, "kAubioBufferSize / kAubioHopSize has no remainder");
-
-// -----------------------------------------------------------------------
-
 class AudioToCVPitch : public Plugin
 {
     enum Parameters {
@@ -53,12 +37,26 @@ class AudioToCVPitch : public Plugin
         paramHoldOutputPitch,
         paramDetectedPitch,
         paramPitchConfidence,
+        // added after the parameters above, keeping their indices for existing sessions
+        paramFastAttack,
+        paramWindowPeriods,
+        paramPreFilter,
+        paramLowestPitch,
+        paramHighestPitch,
+        paramBeatTracking,
+        paramTimbreOutputs,
+        paramDetectedTempo,
         paramCount
     };
 
     enum Outputs {
         outputPitch,
-        outputSignal
+        outputSignal,
+        outputBeat,
+        outputTempo,
+        outputBrightness,
+        outputRolloff,
+        outputFlux
     };
 
     struct {
@@ -66,35 +64,129 @@ class AudioToCVPitch : public Plugin
         float threshold = kDefaultThreshold;
         int octave = kDefaultOctave;
         bool holdOutputPitch = kDefaultHoldOutputPitch;
+        bool fastAttack = kDefaultFastAttack;
+        int windowPeriods = kDefaultWindowPeriods;
+        bool preFilter = kDefaultPreFilter;
+        float lowestPitch = kDefaultLowestPitch;
+        float highestPitch = kDefaultHighestPitch;
+        bool beatTracking = kDefaultBeatTracking;
+        bool timbreOutputs = kDefaultTimbreOutputs;
     } parameters;
 
     float lastKnownPitchInHz = 0.f;
     float lastKnownPitchConfidence = 0.f;
+    float lastKnownTempo = 0.f;
 
     float lastUsedOutputPitch = 0.f;
     float lastUsedOutputSignal = 0.f;
+    float lastUsedOutputTempo = 0.f;
+    float lastUsedOutputBrightness = 0.f;
+    float lastUsedOutputRolloff = 0.f;
+    float lastUsedOutputFlux = 0.f;
+
+    // band-limiting of the input, done a block at a time before the per-sample analysis
+    fvec_t* const filterBuffer = new_fvec(kPreFilterBlockSize);
+    aubio_filter_t* const highPassFilter = new_aubio_filter(3);
+    aubio_filter_t* const lowPassFilter = new_aubio_filter(3);
+
+    // range the filters are currently set to, moved towards the parameters from run()
+    float preFilterLowestPitch = kDefaultLowestPitch;
+    float preFilterHighestPitch = kDefaultHighestPitch;
+    bool preFilterActive = false;
 
     fvec_t* const detectedPitch = new_fvec(1);
     fvec_t* const inputBuffer = new_fvec(kAubioBufferSize);
     uint32_t inputBufferPos = 0;
 
-    aubio_pitch_t* pitchDetector = nullptr;
+    // the full buffer analysis, same as aubio yinfast but with its sizes fixed at build time
+    YinFast<kAubioBufferSize> pitchDetector;
+
+    // one spectrum per onset hop, shared by onset detection and beat tracking
+    aubio_frontend_t* const frontend = new_aubio_frontend(kAubioOnsetBufferSize, kAubioOnsetHopSize);
+
+    // onset detection, restarts the analysis frame at note attacks
+    fvec_t* const detectedOnset = new_fvec(1);
+    fvec_t* const onsetBuffer = new_fvec(kAubioOnsetHopSize);
+    fvec_t* const onsetHistory = new_fvec(kAubioBufferSize);
+    uint32_t onsetBufferPos = 0;
+    uint32_t onsetHistoryPos = 0;
+    uint32_t onsetFramesProcessed = 0;
+
+    aubio_onset_t* onsetDetector = nullptr;
+
+    // beat tracking, analyses one out of every few onset hops
+    fvec_t* const detectedBeat = new_fvec(2);
+    fvec_t* const tempoBuffer = new_fvec(kAubioTempoHopSize);
+    uint32_t tempoHopPos = 0;
+    uint32_t beatTriggerFramesLeft = 0;
+
+    aubio_tempo_t* tempoDetector = nullptr;
+
+    // spectral shape of the onset spectra, for the timbre outputs
+    fvec_t* const spectralStats = new_fvec(aubio_specstat_count);
+    fvec_t* const detectedFlux = new_fvec(1);
+    aubio_specdesc_t* const fluxDetector = new_aubio_specdesc("specflux", kAubioOnsetBufferSize);
+
+    // short windows analysed after an onset, before the full buffer is available
+    aubio_pitch_t* earlyPitchDetectors[kAubioEarlyBufferCount] = {};
+    uint32_t earlyStage = kAubioEarlyBufferCount;
+
+    // shorter windows analysed while a stable pitch is tracked, kAubioAdaptiveBufferCount means the full buffer
+    aubio_pitch_t* adaptivePitchDetectors[kAubioAdaptiveBufferCount] = {};
+    uint32_t adaptiveStage = kAubioAdaptiveBufferCount;
+    uint32_t analysisBufferSize = kAubioBufferSize;
+    uint32_t stableFrames = 0;
+    float stablePitchInHz = 0.f;
 
 public:
     AudioToCVPitch()
         : Plugin(paramCount, 1, 0)
     {
+        pitchDetector.setSilence(kAubioSilence);
+        pitchDetector.setTolerance(kDefaultTolerance * 0.01f);
+
         setLatency(kAubioBufferSize);
         recreateAubioPitchDetector(getSampleRate());
     }
 
     ~AudioToCVPitch() override
     {
-        if (pitchDetector != nullptr)
-            del_aubio_pitch(pitchDetector);
+        if (onsetDetector != nullptr)
+            del_aubio_onset(onsetDetector);
+
+        if (tempoDetector != nullptr)
+            del_aubio_tempo(tempoDetector);
+
+        for (uint32_t i = 0; i < kAubioEarlyBufferCount; ++i)
+        {
+            if (earlyPitchDetectors[i] != nullptr)
+                del_aubio_pitch(earlyPitchDetectors[i]);
+        }
+
+        for (uint32_t i = 0; i < kAubioAdaptiveBufferCount; ++i)
+        {
+            if (adaptivePitchDetectors[i] != nullptr)
+                del_aubio_pitch(adaptivePitchDetectors[i]);
+        }
 
+        del_aubio_filter(highPassFilter);
+        del_aubio_filter(lowPassFilter);
+        del_fvec(filterBuffer);
         del_fvec(detectedPitch);
         del_fvec(inputBuffer);
+        del_fvec(detectedOnset);
+        del_fvec(onsetBuffer);
+        del_fvec(onsetHistory);
+        del_fvec(detectedBeat);
+        del_fvec(tempoBuffer);
+        del_fvec(spectralStats);
+        del_fvec(detectedFlux);
+
+        if (fluxDetector != nullptr)
+            del_aubio_specdesc(fluxDetector);
+
+        if (frontend != nullptr)
+            del_aubio_frontend(frontend);
     }
 
 protected:
@@ -156,6 +248,31 @@ protected:
             port.symbol = "Gate";
             port.hints  = kAudioPortIsCV | kCVPortHasPositiveUnipolarRange | kCVPortHasScaledRange;
             break;
+        case outputBeat:
+            port.name   = "Beat";
+            port.symbol = "Beat";
+            port.hints  = kAudioPortIsCV | kCVPortHasPositiveUnipolarRange | kCVPortHasScaledRange;
+            break;
+        case outputTempo:
+            port.name   = "Tempo";
+            port.symbol = "Tempo";
+            port.hints  = kAudioPortIsCV | kCVPortHasPositiveUnipolarRange | kCVPortHasScaledRange;
+            break;
+        case outputBrightness:
+            port.name   = "Brightness";
+            port.symbol = "Brightness";
+            port.hints  = kAudioPortIsCV | kCVPortHasPositiveUnipolarRange | kCVPortHasScaledRange;
+            break;
+        case outputRolloff:
+            port.name   = "Roll-off";
+            port.symbol = "Rolloff";
+            port.hints  = kAudioPortIsCV | kCVPortHasPositiveUnipolarRange | kCVPortHasScaledRange;
+            break;
+        case outputFlux:
+            port.name   = "Flux";
+            port.symbol = "Flux";
+            port.hints  = kAudioPortIsCV | kCVPortHasPositiveUnipolarRange | kCVPortHasScaledRange;
+            break;
         }
     }
 
@@ -224,6 +341,73 @@ protected:
             parameter.ranges.min = 0;
             parameter.ranges.max = 100;
             break;
+        case paramFastAttack:
+            parameter.hints = kParameterIsAutomatable | kParameterIsInteger | kParameterIsBoolean;
+            parameter.name = "Fast Attack";
+            parameter.symbol = "FastAttack";
+            parameter.ranges.def = kDefaultFastAttack;
+            parameter.ranges.min = 0;
+            parameter.ranges.max = 1;
+            break;
+        case paramWindowPeriods:
+            parameter.hints = kParameterIsAutomatable | kParameterIsInteger;
+            parameter.name = "Window Periods";
+            parameter.symbol = "WindowPeriods";
+            parameter.ranges.def = kDefaultWindowPeriods;
+            parameter.ranges.min = 0;
+            parameter.ranges.max = 16;
+            break;
+        case paramPreFilter:
+            parameter.hints = kParameterIsAutomatable | kParameterIsInteger | kParameterIsBoolean;
+            parameter.name = "Pre-Filter";
+            parameter.symbol = "PreFilter";
+            parameter.ranges.def = kDefaultPreFilter;
+            parameter.ranges.min = 0;
+            parameter.ranges.max = 1;
+            break;
+        case paramLowestPitch:
+            parameter.hints = kParameterIsAutomatable | kParameterIsLogarithmic;
+            parameter.name = "Lowest Pitch";
+            parameter.symbol = "LowestPitch";
+            parameter.unit = "Hz";
+            parameter.ranges.def = kDefaultLowestPitch;
+            parameter.ranges.min = 20.f;
+            parameter.ranges.max = 1000.f;
+            break;
+        case paramHighestPitch:
+            parameter.hints = kParameterIsAutomatable | kParameterIsLogarithmic;
+            parameter.name = "Highest Pitch";
+            parameter.symbol = "HighestPitch";
+            parameter.unit = "Hz";
+            parameter.ranges.def = kDefaultHighestPitch;
+            parameter.ranges.min = 100.f;
+            parameter.ranges.max = 5000.f;
+            break;
+        case paramBeatTracking:
+            parameter.hints = kParameterIsAutomatable | kParameterIsInteger | kParameterIsBoolean;
+            parameter.name = "Beat Tracking";
+            parameter.symbol = "BeatTracking";
+            parameter.ranges.def = kDefaultBeatTracking;
+            parameter.ranges.min = 0;
+            parameter.ranges.max = 1;
+            break;
+        case paramTimbreOutputs:
+            parameter.hints = kParameterIsAutomatable | kParameterIsInteger | kParameterIsBoolean;
+            parameter.name = "Timbre Outputs";
+            parameter.symbol = "TimbreOutputs";
+            parameter.ranges.def = kDefaultTimbreOutputs;
+            parameter.ranges.min = 0;
+            parameter.ranges.max = 1;
+            break;
+        case paramDetectedTempo:
+            parameter.hints = kParameterIsAutomatable | kParameterIsOutput;
+            parameter.name = "Detected Tempo";
+            parameter.symbol = "DetectedTempo";
+            parameter.unit = "BPM";
+            parameter.ranges.def = 0;
+            parameter.ranges.min = 0;
+            parameter.ranges.max = 300;
+            break;
         }
     }
 
@@ -247,7 +431,7 @@ protected:
         case paramConfidenceThreshold:
             return parameters.threshold * 100.f;
         case paramTolerance:
-            return aubio_pitch_get_tolerance(pitchDetector) * 100.f;
+            return pitchDetector.getTolerance() * 100.f;
         case paramOctave:
             return parameters.octave;
         case paramHoldOutputPitch:
@@ -256,6 +440,22 @@ protected:
             return lastKnownPitchInHz;
         case paramPitchConfidence:
             return lastKnownPitchConfidence * 100.f;
+        case paramFastAttack:
+            return parameters.fastAttack ? 1.0f : 0.0f;
+        case paramWindowPeriods:
+            return parameters.windowPeriods;
+        case paramPreFilter:
+            return parameters.preFilter ? 1.0f : 0.0f;
+        case paramLowestPitch:
+            return parameters.lowestPitch;
+        case paramHighestPitch:
+            return parameters.highestPitch;
+        case paramBeatTracking:
+            return parameters.beatTracking ? 1.0f : 0.0f;
+        case paramTimbreOutputs:
+            return parameters.timbreOutputs ? 1.0f : 0.0f;
+        case paramDetectedTempo:
+            return lastKnownTempo;
         default:
             return 0.0f;
         }
@@ -272,7 +472,7 @@ protected:
             parameters.threshold = value * 0.01f;
             break;
         case paramTolerance:
-            aubio_pitch_set_tolerance(pitchDetector, value * 0.01f);
+            setTolerance(value * 0.01f);
             break;
         case paramOctave:
             parameters.octave = std::lrintf(value);
@@ -280,6 +480,27 @@ protected:
         case paramHoldOutputPitch:
             parameters.holdOutputPitch = value > 0.5f;
             break;
+        case paramFastAttack:
+            parameters.fastAttack = value > 0.5f;
+            break;
+        case paramWindowPeriods:
+            parameters.windowPeriods = std::lrintf(value);
+            break;
+        case paramPreFilter:
+            parameters.preFilter = value > 0.5f;
+            break;
+        case paramLowestPitch:
+            parameters.lowestPitch = value;
+            break;
+        case paramHighestPitch:
+            parameters.highestPitch = value;
+            break;
+        case paramBeatTracking:
+            parameters.beatTracking = value > 0.5f;
+            break;
+        case paramTimbreOutputs:
+            parameters.timbreOutputs = value > 0.5f;
+            break;
         }
     }
 
@@ -292,7 +513,14 @@ protected:
         parameters.threshold = kDefaultThreshold;
         parameters.octave = kDefaultOctave;
         parameters.holdOutputPitch = kDefaultHoldOutputPitch;
-        aubio_pitch_set_tolerance(pitchDetector, kDefaultTolerance * 0.01f);
+        parameters.fastAttack = kDefaultFastAttack;
+        parameters.windowPeriods = kDefaultWindowPeriods;
+        parameters.preFilter = kDefaultPreFilter;
+        parameters.lowestPitch = kDefaultLowestPitch;
+        parameters.highestPitch = kDefaultHighestPitch;
+        parameters.beatTracking = kDefaultBeatTracking;
+        parameters.timbreOutputs = kDefaultTimbreOutputs;
+        setTolerance(kDefaultTolerance * 0.01f);
     }
 
     // -------------------------------------------------------------------
@@ -301,31 +529,115 @@ protected:
     void activate() override
     {
         inputBufferPos = 0;
+        onsetBufferPos = 0;
+        onsetHistoryPos = 0;
+        fvec_zeros(onsetHistory);
+        tempoHopPos = 0;
+        beatTriggerFramesLeft = 0;
+        earlyStage = kAubioEarlyBufferCount;
+        resetAnalysisWindow();
+        preFilterActive = false;
     }
 
     void run(const float** const inputs, float** const outputs, const uint32_t numFrames) override
     {
         float cvPitch = lastUsedOutputPitch;
         float cvSignal = lastUsedOutputSignal;
+        float cvTempo = lastUsedOutputTempo;
+        float cvBrightness = lastUsedOutputBrightness;
+        float cvRolloff = lastUsedOutputRolloff;
+        float cvFlux = lastUsedOutputFlux;
+        const bool analyseOnsets = parameters.fastAttack && onsetDetector != nullptr;
+        const bool trackBeats = parameters.beatTracking && tempoDetector != nullptr && frontend != nullptr;
+        const bool analyseTimbre = parameters.timbreOutputs && fluxDetector != nullptr && frontend != nullptr;
 
         for (uint32_t i = 0; i < numFrames; ++i)
         {
-            inputBuffer->data[inputBufferPos] = inputs[0][i] * parameters.sensitivity;
+            if (i % kPreFilterBlockSize == 0)
+                filterInput(inputs[0] + i, std::min(numFrames - i, kPreFilterBlockSize));
+
+            const float sample = filterBuffer->data[i % kPreFilterBlockSize];
+
+            inputBuffer->data[inputBufferPos++] = sample;
+
+            // always kept up to date, so it is valid as soon as one of the features below is enabled
+            onsetHistory->data[onsetHistoryPos] = sample;
+            if (++onsetHistoryPos == kAubioBufferSize)
+                onsetHistoryPos = 0;
 
-            if (++inputBufferPos == kAubioBufferSize)
+            if (analyseOnsets || trackBeats || analyseTimbre)
+            {
+                onsetBuffer->data[onsetBufferPos] = sample;
+
+                if (++onsetBufferPos == kAubioOnsetHopSize)
+                {
+                    onsetBufferPos = 0;
+                    analyseOnsetHop(analyseOnsets, trackBeats, analyseTimbre, cvTempo, cvBrightness, cvRolloff, cvFlux);
+                }
+            }
+
+            if (analyseOnsets)
+            {
+                // try shorter windows starting at the attack, in case enough periods are already there
+                while (earlyStage < kAubioEarlyBufferCount && inputBufferPos >= kAubioEarlyBufferSizes[earlyStage])
+                {
+                    const uint32_t earlyBufferSize = kAubioEarlyBufferSizes[earlyStage];
+                    aubio_pitch_t* const earlyPitchDetector = earlyPitchDetectors[earlyStage++];
+
+                    if (earlyPitchDetector == nullptr)
+                        continue;
+
+                    fvec_t earlyBuffer;
+                    earlyBuffer.data = inputBuffer->data + inputBufferPos - earlyBufferSize;
+                    earlyBuffer.length = earlyBufferSize;
+
+                    aubio_pitch_do(earlyPitchDetector, &earlyBuffer, detectedPitch);
+                    const float detectedPitchInHz = fvec_get_sample(detectedPitch, 0);
+                    const float pitchConfidence = aubio_pitch_get_confidence(earlyPitchDetector);
+
+                    // only a confident result is used, otherwise wait for the next window
+                    if (detectedPitchInHz > 0.f && pitchConfidence >= parameters.threshold)
+                    {
+                        cvPitch = pitchInHzToCV(detectedPitchInHz, parameters.octave);
+                        lastKnownPitchInHz = detectedPitchInHz;
+                        lastKnownPitchConfidence = pitchConfidence;
+                        cvSignal = 10.f;
+                    }
+                }
+            }
+
+            if (inputBufferPos == analysisBufferSize)
             {
                 inputBufferPos = 0;
+                earlyStage = kAubioEarlyBufferCount;
 
-                aubio_pitch_do(pitchDetector, inputBuffer, detectedPitch);
-                const float detectedPitchInHz = fvec_get_sample(detectedPitch, 0);
-                const float pitchConfidence = aubio_pitch_get_confidence(pitchDetector);
+                float detectedPitchInHz, pitchConfidence;
+
+                if (adaptiveStage < kAubioAdaptiveBufferCount)
+                {
+                    aubio_pitch_t* const detector = adaptivePitchDetectors[adaptiveStage];
+
+                    fvec_t analysisBuffer;
+                    analysisBuffer.data = inputBuffer->data;
+                    analysisBuffer.length = analysisBufferSize;
+
+                    aubio_pitch_do(detector, &analysisBuffer, detectedPitch);
+                    detectedPitchInHz = fvec_get_sample(detectedPitch, 0);
+                    pitchConfidence = aubio_pitch_get_confidence(detector);
+                }
+                else
+                {
+                    const float period = pitchDetector.process(inputBuffer->data);
+                    detectedPitchInHz = period > 0.f ? getSampleRate() / period : 0.f;
+                    pitchConfidence = pitchDetector.getConfidence();
+                }
 
                 if (detectedPitchInHz > 0.f && pitchConfidence >= parameters.threshold)
                 {
-                    const float linearPitch = 12.f * (log2f(detectedPitchInHz / 440.f) + parameters.octave - 1) + 69.f;
-                    cvPitch = std::max(0.f, std::min(10.f, linearPitch * (1.f/12.f)));
+                    cvPitch = pitchInHzToCV(detectedPitchInHz, parameters.octave);
                     lastKnownPitchInHz = detectedPitchInHz;
                     cvSignal = 10.f;
+                    adaptAnalysisWindow(detectedPitchInHz);
                 }
                 else
                 {
@@ -333,6 +645,7 @@ protected:
                         lastKnownPitchInHz = cvPitch = 0.0f;
 
                     cvSignal = 0.f;
+                    resetAnalysisWindow();
                 }
 
                 lastKnownPitchConfidence = pitchConfidence;
@@ -340,10 +653,22 @@ protected:
 
             outputs[outputPitch][i] = cvPitch;
             outputs[outputSignal][i] = cvSignal;
+            outputs[outputBeat][i] = beatTriggerFramesLeft != 0 ? 10.f : 0.f;
+            outputs[outputTempo][i] = cvTempo;
+            outputs[outputBrightness][i] = cvBrightness;
+            outputs[outputRolloff][i] = cvRolloff;
+            outputs[outputFlux][i] = cvFlux;
+
+            if (beatTriggerFramesLeft != 0)
+                --beatTriggerFramesLeft;
         }
 
         lastUsedOutputPitch = cvPitch;
         lastUsedOutputSignal = cvSignal;
+        lastUsedOutputTempo = cvTempo;
+        lastUsedOutputBrightness = cvBrightness;
+        lastUsedOutputRolloff = cvRolloff;
+        lastUsedOutputFlux = cvFlux;
     }
 
     void sampleRateChanged(const double newSampleRate) override
@@ -352,26 +677,267 @@ protected:
     }
 
 private:
-    void recreateAubioPitchDetector(const double sampleRate)
+    // compute the spectrum of the last onset hop once, then run onset detection, timbre analysis and beat tracking on it
+    void analyseOnsetHop(const bool analyseOnsets, const bool trackBeats, const bool analyseTimbre,
+                         float& cvTempo, float& cvBrightness, float& cvRolloff, float& cvFlux)
+    {
+        const cvec_t* spectrum = nullptr;
+
+        if (frontend != nullptr)
+        {
+            aubio_frontend_do(frontend, onsetBuffer);
+            spectrum = aubio_frontend_get_spectrum(frontend);
+        }
+
+        if (analyseOnsets)
+        {
+            onsetFramesProcessed += kAubioOnsetHopSize;
+
+            if (spectrum != nullptr)
+                aubio_onset_do_spectrum(onsetDetector, onsetBuffer, spectrum, detectedOnset);
+            else
+                aubio_onset_do(onsetDetector, onsetBuffer, detectedOnset);
+
+            if (fvec_get_sample(detectedOnset, 0) > 0.f)
+                restartAtOnset();
+        }
+
+        if (analyseTimbre && spectrum != nullptr)
+            analyseSpectralShape(spectrum, cvBrightness, cvRolloff, cvFlux);
+
+        if (! trackBeats)
+            return;
+
+        tempoHopPos = (tempoHopPos + kAubioOnsetHopSize) % kAubioTempoHopSize;
+
+        if (tempoHopPos != 0)
+            return;
+
+        // the input is only used to mute beats over silence, which must cover the whole tempo hop
+        for (uint32_t i = 0; i < kAubioTempoHopSize; ++i)
+            tempoBuffer->data[i] = onsetHistory->data[(onsetHistoryPos + kAubioBufferSize - kAubioTempoHopSize + i) % kAubioBufferSize];
+
+        aubio_tempo_do_spectrum(tempoDetector, tempoBuffer, spectrum, detectedBeat);
+
+        if (fvec_get_sample(detectedBeat, 0) != 0.f)
+            beatTriggerFramesLeft = kBeatTriggerSeconds * getSampleRate();
+
+        lastKnownTempo = aubio_tempo_get_bpm(tempoDetector);
+        cvTempo = std::max(0.f, std::min(10.f, lastKnownTempo / kTempoBPMPerVolt));
+    }
+
+    // centroid and roll-off as 1V/Oct like the pitch output, so they can drive a filter cutoff,
+    // and flux as the share of the spectrum that is new since the last hop, 0-10V
+    void analyseSpectralShape(const cvec_t* const spectrum, float& cvBrightness, float& cvRolloff, float& cvFlux)
+    {
+        // always run, so the flux compares with the previous hop when the input comes back
+        aubio_specdesc_do(fluxDetector, spectrum, detectedFlux);
+
+        if (aubio_silence_detection(onsetBuffer, kAubioSilence))
+        {
+            cvBrightness = cvRolloff = cvFlux = 0.f;
+            return;
+        }
+
+        aubio_specdesc_statistics(spectrum, spectralStats);
+
+        const float sum = fvec_get_sample(spectralStats, aubio_specstat_sum);
+        const float binToHz = getSampleRate() / kAubioOnsetBufferSize;
+        const float centroidInHz = fvec_get_sample(spectralStats, aubio_specstat_centroid) * binToHz;
+        const float rolloffInHz = fvec_get_sample(spectralStats, aubio_specstat_rolloff) * binToHz;
+
+        // a spectrum with its energy in the DC bin gives 0 Hz, which has no 1V/Oct value
+        cvBrightness = centroidInHz > 0.f ? pitchInHzToCV(centroidInHz, 0) : 0.f;
+        cvRolloff = rolloffInHz > 0.f ? pitchInHzToCV(rolloffInHz, 0) : 0.f;
+        cvFlux = sum > 0.f ? std::min(10.f, 10.f * fvec_get_sample(detectedFlux, 0) / sum) : 0.f;
+    }
+
+    // scale the next block of input into filterBuffer, band-limited to the pitch range if enabled
+    void filterInput(const float* const input, const uint32_t frames)
+    {
+        fvec_t block;
+        block.data = filterBuffer->data;
+        block.length = frames;
+
+        for (uint32_t i = 0; i < frames; ++i)
+            block.data[i] = input[i] * parameters.sensitivity;
+
+        if (! parameters.preFilter)
+        {
+            preFilterActive = false;
+            return;
+        }
+
+        // the coefficients are only changed here, between two blocks of the same thread
+        if (! preFilterActive)
+        {
+            // nothing to ramp from, start from silence at the requested range
+            preFilterActive = true;
+            preFilterLowestPitch = parameters.lowestPitch;
+            preFilterHighestPitch = parameters.highestPitch;
+            updatePreFilter(getSampleRate());
+            aubio_filter_do_reset(highPassFilter);
+            aubio_filter_do_reset(lowPassFilter);
+        }
+        else if (preFilterLowestPitch != parameters.lowestPitch || preFilterHighestPitch != parameters.highestPitch)
+        {
+            // the filters keep their memory, moving the range in small steps avoids clicks
+            preFilterLowestPitch = rampPreFilterCutoff(preFilterLowestPitch, parameters.lowestPitch);
+            preFilterHighestPitch = rampPreFilterCutoff(preFilterHighestPitch, parameters.highestPitch);
+            updatePreFilter(getSampleRate());
+        }
+
+        aubio_filter_do(highPassFilter, &block);
+        aubio_filter_do(lowPassFilter, &block);
+    }
+
+    static float rampPreFilterCutoff(const float current, const float target)
+    {
+        return std::max(current / kPreFilterMaxStepRatio, std::min(current * kPreFilterMaxStepRatio, target));
+    }
+
+    void updatePreFilter(const double sampleRate)
+    {
+        setAubioPreFilter(highPassFilter, sampleRate, preFilterLowestPitch * kPreFilterHighPassRatio, true);
+        setAubioPreFilter(lowPassFilter, sampleRate, preFilterHighestPitch * kPreFilterLowPassRatio, false);
+    }
+
+    void setTolerance(const float tolerance)
     {
-        float tolerance;
+        pitchDetector.setTolerance(tolerance);
+
+        for (uint32_t i = 0; i < kAubioEarlyBufferCount; ++i)
+        {
+            if (earlyPitchDetectors[i] != nullptr)
+                aubio_pitch_set_tolerance(earlyPitchDetectors[i], tolerance);
+        }
 
-        if (pitchDetector != nullptr)
+        for (uint32_t i = 0; i < kAubioAdaptiveBufferCount; ++i)
         {
-            tolerance = aubio_pitch_get_tolerance(pitchDetector);
-            del_aubio_pitch(pitchDetector);
+            if (adaptivePitchDetectors[i] != nullptr)
+                aubio_pitch_set_tolerance(adaptivePitchDetectors[i], tolerance);
         }
+    }
+
+    // once the same pitch was found a few times in a row, only analyse the last few of its periods,
+    // which is enough for YIN and reduces both latency and CPU usage
+    void adaptAnalysisWindow(const float pitchInHz)
+    {
+        if (stableFrames != 0 && std::abs(1200.f * std::log2(pitchInHz / stablePitchInHz)) <= kAubioAdaptiveStableCents)
+            ++stableFrames;
         else
+            stableFrames = 1;
+
+        stablePitchInHz = pitchInHz;
+
+        uint32_t stage = kAubioAdaptiveBufferCount;
+
+        if (parameters.windowPeriods > 0 && stableFrames >= kAubioAdaptiveStableFrames)
         {
-            tolerance = kDefaultTolerance * 0.01f;
+            // 1 and 2 periods would put the period at or past the end of the lags yinfast searches
+            const int periods = std::max(parameters.windowPeriods, kAubioAdaptiveMinPeriods);
+            const float neededSize = periods * getSampleRate() / pitchInHz;
+
+            for (uint32_t i = 0; i < kAubioAdaptiveBufferCount; ++i)
+            {
+                if (adaptivePitchDetectors[i] != nullptr && kAubioAdaptiveBufferSizes[i] >= neededSize)
+                {
+                    stage = i;
+                    break;
+                }
+            }
         }
 
-        pitchDetector = new_aubio_pitch("yinfast", kAubioBufferSize, kAubioHopSize, sampleRate);
-        DISTRHO_SAFE_ASSERT_RETURN(pitchDetector != nullptr,);
+        setAnalysisWindow(stage);
+    }
+
+    // go back to the full buffer until a pitch is stable again
+    void resetAnalysisWindow()
+    {
+        stableFrames = 0;
+        setAnalysisWindow(kAubioAdaptiveBufferCount);
+    }
+
+    // switch to another analysis window, at a frame boundary.
+    // the reported latency stays the full buffer, so the host does not redo its delay compensation
+    // during playback, shorter windows only let the outputs follow the input earlier than reported.
+    void setAnalysisWindow(const uint32_t stage)
+    {
+        adaptiveStage = stage;
+        analysisBufferSize = stage < kAubioAdaptiveBufferCount ? kAubioAdaptiveBufferSizes[stage] : kAubioBufferSize;
+    }
+
+    // restart the analysis frame at the last onset, keeping the samples received since then.
+    // the onset position is only known to about half a hop, skipping that avoids starting
+    // the frame with silence or the end of the previous note, which leads to octave errors.
+    void restartAtOnset()
+    {
+        const uint32_t sinceOnset = std::min(onsetFramesProcessed - aubio_onset_get_last(onsetDetector),
+                                             kAubioBufferSize - 1);
+        const uint32_t sinceAttack = sinceOnset > kAubioOnsetHopSize / 2 ? sinceOnset - kAubioOnsetHopSize / 2 : 0;
 
-        aubio_pitch_set_silence(pitchDetector, -30.0f);
-        aubio_pitch_set_tolerance(pitchDetector, tolerance);
-        aubio_pitch_set_unit(pitchDetector, "Hz");
+        for (uint32_t i = 0; i < sinceAttack; ++i)
+            inputBuffer->data[i] = onsetHistory->data[(onsetHistoryPos + kAubioBufferSize - sinceAttack + i) % kAubioBufferSize];
+
+        // a new note starts, wait for its pitch to be stable
+        resetAnalysisWindow();
+
+        inputBufferPos = sinceAttack;
+        earlyStage = 0;
+    }
+
+    void recreateAubioPitchDetector(const double sampleRate)
+    {
+        // the full buffer detector does not depend on the sample rate, the others follow its tolerance
+        const float tolerance = pitchDetector.getTolerance();
+
+        if (onsetDetector != nullptr)
+            del_aubio_onset(onsetDetector);
+
+        onsetDetector = createAubioOnsetDetector(sampleRate);
+        onsetFramesProcessed = 0;
+        DISTRHO_SAFE_ASSERT(onsetDetector != nullptr);
+
+        if (tempoDetector != nullptr)
+            del_aubio_tempo(tempoDetector);
+
+        tempoDetector = createAubioTempoDetector(sampleRate);
+        tempoHopPos = 0;
+        lastKnownTempo = lastUsedOutputTempo = 0.f;
+        DISTRHO_SAFE_ASSERT(tempoDetector != nullptr);
+
+        for (uint32_t i = 0; i < kAubioEarlyBufferCount; ++i)
+        {
+            if (earlyPitchDetectors[i] != nullptr)
+                del_aubio_pitch(earlyPitchDetectors[i]);
+
+            earlyPitchDetectors[i] = new_aubio_pitch(kAubioMethod, kAubioEarlyBufferSizes[i], kAubioEarlyBufferSizes[i], sampleRate);
+            DISTRHO_SAFE_ASSERT_CONTINUE(earlyPitchDetectors[i] != nullptr);
+
+            aubio_pitch_set_silence(earlyPitchDetectors[i], kAubioSilence);
+            aubio_pitch_set_tolerance(earlyPitchDetectors[i], tolerance);
+            aubio_pitch_set_unit(earlyPitchDetectors[i], "Hz");
+        }
+
+        for (uint32_t i = 0; i < kAubioAdaptiveBufferCount; ++i)
+        {
+            if (adaptivePitchDetectors[i] != nullptr)
+                del_aubio_pitch(adaptivePitchDetectors[i]);
+
+            adaptivePitchDetectors[i] = new_aubio_pitch(kAubioMethod, kAubioAdaptiveBufferSizes[i], kAubioAdaptiveBufferSizes[i], sampleRate);
+            DISTRHO_SAFE_ASSERT_CONTINUE(adaptivePitchDetectors[i] != nullptr);
+
+            aubio_pitch_set_silence(adaptivePitchDetectors[i], kAubioSilence);
+            aubio_pitch_set_tolerance(adaptivePitchDetectors[i], tolerance);
+            aubio_pitch_set_unit(adaptivePitchDetectors[i], "Hz");
+        }
+
+        preFilterLowestPitch = parameters.lowestPitch;
+        preFilterHighestPitch = parameters.highestPitch;
+        updatePreFilter(sampleRate);
+
+        inputBufferPos = 0;
+        resetAnalysisWindow();
     }
 
     DISTRHO_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AudioToCVPitch)
@@ -0,0 +1,376 @@
+/*
+ * DISTRHO PitchTracking Series
+ * Copyright (C) 2021-2022 Bram Giesen
+ * Copyright (C) 2022 Filipe Coelho <falktx@falktx.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 3 of
+ * the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * For a full copy of the GNU General Public License see the LICENSE file.
+ */
+
+#include "DistrhoPlugin.hpp"
+#include "PitchTracking.hpp"
+
+START_NAMESPACE_DISTRHO
+
+// -----------------------------------------------------------------------
+
+class AudioToMIDIPitch : public Plugin
+{
+    enum Parameters {
+        paramSensitivity = 0,
+        paramSilenceThreshold,
+        paramReleaseDrop,
+        paramMinInterval,
+        paramEarlyConfidence,
+        paramOctave,
+        paramDetectedNote,
+        paramCount
+    };
+
+    struct {
+        float sensitivity = kDefaultSensitivity;
+        float silence = kDefaultNotesSilence;
+        float releaseDrop = kDefaultNotesReleaseDrop;
+        float minInterval = kDefaultNotesMinInterval;
+        float earlyConfidence = kDefaultNotesEarlyConfidence;
+        int octave = kDefaultOctave;
+    } parameters;
+
+    // currently playing MIDI note, or -1 if none
+    int activeNote = -1;
+
+    // the detector was reset, its notes are released at the start of the next run
+    bool releaseActiveNote = false;
+
+    fvec_t* const detectedNotes = new_fvec(3);
+    fvec_t* const inputBuffer = new_fvec(kAubioNotesHopSize);
+    uint32_t inputBufferPos = 0;
+
+    aubio_notes_t* notesDetector = nullptr;
+
+public:
+    AudioToMIDIPitch()
+        : Plugin(paramCount, 1, 0)
+    {
+        // notes are found from the onsets over the last buffer
+        setLatency(kAubioNotesBufferSize);
+        recreateAubioNotesDetector(getSampleRate());
+    }
+
+    ~AudioToMIDIPitch() override
+    {
+        if (notesDetector != nullptr)
+            del_aubio_notes(notesDetector);
+
+        del_fvec(detectedNotes);
+        del_fvec(inputBuffer);
+    }
+
+protected:
+    // -------------------------------------------------------------------
+    // Information
+
+    const char* getLabel() const noexcept override
+    {
+        return "AudioToMIDIPitch";
+    }
+
+    const char* getDescription() const override
+    {
+        return "This plugin converts a monophonic audio signal to MIDI notes";
+    }
+
+    const char* getMaker() const noexcept override
+    {
+        return "Bram Giesen and falkTX";
+    }
+
+    const char* getHomePage() const override
+    {
+        return "https://github.com/DISTRHO/PitchTrackingSeries";
+    }
+
+    const char* getLicense() const noexcept override
+    {
+        return "GPLv3+";
+    }
+
+    uint32_t getVersion() const noexcept override
+    {
+        return d_version(1, 0, 0);
+    }
+
+    int64_t getUniqueId() const noexcept override
+    {
+        return d_cconst('P', 'T', 'm', 'd');
+    }
+
+    // -------------------------------------------------------------------
+    // Init
+
+    void initParameter(const uint32_t index, Parameter& parameter) override
+    {
+        switch (index)
+        {
+        case paramSensitivity:
+            parameter.hints = kParameterIsAutomatable;
+            parameter.name = "Sensitivity";
+            parameter.symbol = "Sensitivity";
+            parameter.unit = "%";
+            parameter.ranges.def = kDefaultSensitivity;
+            parameter.ranges.min = 0.1f;
+            parameter.ranges.max = 100.f;
+            break;
+        case paramSilenceThreshold:
+            parameter.hints = kParameterIsAutomatable;
+            parameter.name = "Silence Threshold";
+            parameter.symbol = "SilenceThreshold";
+            parameter.unit = "dB";
+            parameter.ranges.def = kDefaultNotesSilence;
+            parameter.ranges.min = -90.f;
+            parameter.ranges.max = 0.f;
+            break;
+        case paramReleaseDrop:
+            parameter.hints = kParameterIsAutomatable;
+            parameter.name = "Release Drop";
+            parameter.symbol = "ReleaseDrop";
+            parameter.unit = "dB";
+            parameter.ranges.def = kDefaultNotesReleaseDrop;
+            parameter.ranges.min = 1.f;
+            parameter.ranges.max = 60.f;
+            break;
+        case paramMinInterval:
+            parameter.hints = kParameterIsAutomatable;
+            parameter.name = "Minimum Note Interval";
+            parameter.symbol = "MinInterval";
+            parameter.unit = "ms";
+            parameter.ranges.def = kDefaultNotesMinInterval;
+            parameter.ranges.min = 0.f;
+            parameter.ranges.max = 500.f;
+            break;
+        case paramEarlyConfidence:
+            parameter.hints = kParameterIsAutomatable;
+            parameter.name = "Early Note Confidence";
+            parameter.symbol = "EarlyConfidence";
+            parameter.unit = "%";
+            parameter.ranges.def = kDefaultNotesEarlyConfidence;
+            parameter.ranges.min = 0.f;
+            parameter.ranges.max = 100.f;
+            break;
+        case paramOctave:
+            parameter.hints = kParameterIsAutomatable | kParameterIsInteger;
+            parameter.name = "Octave";
+            parameter.symbol = "Octave";
+            parameter.ranges.def = kDefaultOctave;
+            parameter.ranges.min = -4;
+            parameter.ranges.max = 4;
+            break;
+        case paramDetectedNote:
+            parameter.hints = kParameterIsAutomatable | kParameterIsInteger | kParameterIsOutput;
+            parameter.name = "Detected Note";
+            parameter.symbol = "DetectedNote";
+            parameter.ranges.def = -1;
+            parameter.ranges.min = -1;
+            parameter.ranges.max = 127;
+            break;
+        }
+    }
+
+    void initProgramName(const uint32_t index, String& programName) override
+    {
+        if (index != 0)
+            return;
+
+        programName = "Default";
+    }
+
+    // -------------------------------------------------------------------
+    // Internal data
+
+    float getParameterValue(const uint32_t index) const override
+    {
+        switch (index)
+        {
+        case paramSensitivity:
+            return parameters.sensitivity;
+        case paramSilenceThreshold:
+            return parameters.silence;
+        case paramReleaseDrop:
+            return parameters.releaseDrop;
+        case paramMinInterval:
+            return parameters.minInterval;
+        case paramEarlyConfidence:
+            return parameters.earlyConfidence;
+        case paramOctave:
+            return parameters.octave;
+        case paramDetectedNote:
+            return activeNote;
+        default:
+            return 0.0f;
+        }
+    }
+
+    void setParameterValue(const uint32_t index, const float value) override
+    {
+        switch (index)
+        {
+        case paramSensitivity:
+            parameters.sensitivity = value;
+            break;
+        case paramSilenceThreshold:
+            parameters.silence = value;
+            if (notesDetector != nullptr)
+                aubio_notes_set_silence(notesDetector, value);
+            break;
+        case paramReleaseDrop:
+            parameters.releaseDrop = value;
+            if (notesDetector != nullptr)
+                aubio_notes_set_release_drop(notesDetector, value);
+            break;
+        case paramMinInterval:
+            parameters.minInterval = value;
+            if (notesDetector != nullptr)
+                aubio_notes_set_minioi_ms(notesDetector, value);
+            break;
+        case paramEarlyConfidence:
+            parameters.earlyConfidence = value;
+            if (notesDetector != nullptr)
+                aubio_notes_set_early_confidence(notesDetector, value * 0.01f);
+            break;
+        case paramOctave:
+            parameters.octave = std::lrintf(value);
+            break;
+        }
+    }
+
+    void loadProgram(const uint32_t index) override
+    {
+        if (index != 0)
+            return;
+
+        setParameterValue(paramSensitivity, kDefaultSensitivity);
+        setParameterValue(paramSilenceThreshold, kDefaultNotesSilence);
+        setParameterValue(paramReleaseDrop, kDefaultNotesReleaseDrop);
+        setParameterValue(paramMinInterval, kDefaultNotesMinInterval);
+        setParameterValue(paramEarlyConfidence, kDefaultNotesEarlyConfidence);
+        setParameterValue(paramOctave, kDefaultOctave);
+    }
+
+    // -------------------------------------------------------------------
+    // Process
+
+    void activate() override
+    {
+        inputBufferPos = 0;
+        releaseActiveNote = true;
+    }
+
+    void run(const float** const inputs, float**, const uint32_t numFrames) override
+    {
+        // a new detector never sends the note-off of a note started before it
+        if (releaseActiveNote)
+        {
+            releaseActiveNote = false;
+
+            if (activeNote >= 0)
+            {
+                sendNote(0, activeNote, 0);
+                activeNote = -1;
+            }
+        }
+
+        DISTRHO_SAFE_ASSERT_RETURN(notesDetector != nullptr,);
+
+        for (uint32_t i = 0; i < numFrames; ++i)
+        {
+            inputBuffer->data[inputBufferPos] = inputs[0][i] * parameters.sensitivity;
+
+            if (++inputBufferPos == kAubioNotesHopSize)
+            {
+                inputBufferPos = 0;
+
+                aubio_notes_do(notesDetector, inputBuffer, detectedNotes);
+
+                // note-off first, so a note replaced by the same MIDI note is retriggered
+                if (fvec_get_sample(detectedNotes, 2) != 0.f && activeNote >= 0)
+                {
+                    sendNote(i, activeNote, 0);
+                    activeNote = -1;
+                }
+
+                const float note = fvec_get_sample(detectedNotes, 0);
+
+                if (note > 0.f)
+                {
+                    const int midiNote = static_cast<int>(note + 0.5f) + parameters.octave * 12;
+
+                    if (midiNote >= 0 && midiNote <= 127)
+                    {
+                        const int velocity = static_cast<int>(fvec_get_sample(detectedNotes, 1));
+
+                        if (activeNote >= 0)
+                            sendNote(i, activeNote, 0);
+
+                        sendNote(i, midiNote, std::max(1, std::min(127, velocity)));
+                        activeNote = midiNote;
+                    }
+                }
+            }
+        }
+    }
+
+    void sampleRateChanged(const double newSampleRate) override
+    {
+        recreateAubioNotesDetector(newSampleRate);
+    }
+
+private:
+    void sendNote(const uint32_t frame, const int note, const int velocity)
+    {
+        MidiEvent midiEvent;
+        midiEvent.frame = frame;
+        midiEvent.size = 3;
+        midiEvent.data[0] = velocity != 0 ? 0x90 : 0x80;
+        midiEvent.data[1] = note;
+        midiEvent.data[2] = velocity;
+        midiEvent.data[3] = 0;
+        midiEvent.dataExt = nullptr;
+        writeMidiEvent(midiEvent);
+    }
+
+    void recreateAubioNotesDetector(const double sampleRate)
+    {
+        if (notesDetector != nullptr)
+            del_aubio_notes(notesDetector);
+
+        notesDetector = createAubioNotesDetector(sampleRate,
+                                                 parameters.silence,
+                                                 parameters.releaseDrop,
+                                                 parameters.minInterval,
+                                                 parameters.earlyConfidence * 0.01f);
+        releaseActiveNote = true;
+        DISTRHO_SAFE_ASSERT_RETURN(notesDetector != nullptr,);
+    }
+
+    DISTRHO_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AudioToMIDIPitch)
+};
+
+// -----------------------------------------------------------------------
+
+Plugin* createPlugin()
+{
+    return new AudioToMIDIPitch();
+}
+
+// -----------------------------------------------------------------------
+
+END_NAMESPACE_DISTRHO
@@ -0,0 +1,320 @@
+/*
+ * DISTRHO PitchTracking Series
+ * Copyright (C) 2021-2022 Bram Giesen
+ * Copyright (C) 2022 Filipe Coelho <falktx@falktx.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 3 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * For a full copy of the GNU General Public License see the LICENSE file.
+ */
+
+// Benchmark of aubio_pitch_do for every pitch method, window and hop size.
+// Prints one CSV row per configuration, for comparing methods per platform
+// and catching performance regressions between releases.
+// The "tempo" method times aubio_tempo_do instead, to compare the cost of beat
+// tracking with the pitch detection it would run next to.
+
+#include "PitchTracking.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#if defined(__i386__) || defined(__x86_64__)
+# include <x86intrin.h>
+# define PITCHBENCH_HAS_CYCLES 1
+#endif
+
+// -----------------------------------------------------------------------
+// Allocation counting, glibc lets the executable replace the allocator
+
+static std::atomic<uint64_t> gAllocCount(0);
+
+#ifdef __GLIBC__
+extern "C" {
+void* __libc_malloc(size_t);
+void* __libc_calloc(size_t, size_t);
+void* __libc_realloc(void*, size_t);
+
+void* malloc(size_t size)
+{
+    ++gAllocCount;
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t num, size_t size)
+{
+    ++gAllocCount;
+    return __libc_calloc(num, size);
+}
+
+void* realloc(void* ptr, size_t size)
+{
+    ++gAllocCount;
+    return __libc_realloc(ptr, size);
+}
+}
+# define PITCHBENCH_HAS_ALLOC_COUNT 1
+#endif
+
+// -----------------------------------------------------------------------
+
+static const char* const kMethods[] = {
+    "yin", "yinfast", "yinfft", "mcomb", "fcomb", "schmitt", "specacf", "dual", "pyin", "tempo"
+};
+
+static const char* const kTempoMethod = "tempo";
+
+// includes the window size used by the plugins
+static const uint32_t kWindowSizes[] = {
+    512, 1024, kAubioBufferSize, 2048, 4096
+};
+
+// hop sizes, as divisions of the window size
+static const uint32_t kHopDivisions[] = {
+    1, 2, 4
+};
+
+struct Options {
+    uint32_t sampleRate = 48000;
+    double minSeconds = 0.25;
+    std::vector<std::string> methods;
+    std::vector<uint32_t> windowSizes;
+};
+
+struct Result {
+    uint64_t frames;
+    double nsPerFrame;
+    double realtimeFactor;
+    double cyclesPerSample;
+    uint64_t allocsCreate;
+    double allocsPerFrame;
+};
+
+static inline uint64_t readCycles()
+{
+#ifdef PITCHBENCH_HAS_CYCLES
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+// a harmonic tone with some noise, so that all methods have something to track
+static fvec_t* createSignal(const uint32_t sampleRate, const uint32_t length)
+{
+    fvec_t* const signal = new_fvec(length);
+    uint32_t seed = 1;
+
+    for (uint32_t i = 0; i < length; ++i)
+    {
+        const double t = static_cast<double>(i) / sampleRate;
+        const double f0 = 110.0 * std::pow(2.0, static_cast<double>(i / (sampleRate / 4) % 24) / 12.0);
+        double v = 0.0;
+
+        for (int h = 1; h <= 6; ++h)
+            v += std::sin(2.0 * M_PI * f0 * h * t) / h;
+
+        seed = seed * 1664525u + 1013904223u;
+        v += (static_cast<double>(seed >> 8) / 16777216.0 - 0.5) * 0.02;
+
+        signal->data[i] = static_cast<smpl_t>(v * 0.25);
+    }
+
+    return signal;
+}
+
+// only one of the detectors is set
+static inline void processHop(aubio_pitch_t* const pitchDetector, aubio_tempo_t* const tempoDetector,
+                              const fvec_t* const hop, fvec_t* const out)
+{
+    if (pitchDetector != nullptr)
+        aubio_pitch_do(pitchDetector, hop, out);
+    else
+        aubio_tempo_do(tempoDetector, hop, out);
+}
+
+static bool runBenchmark(const Options& opts, const fvec_t* const signal,
+                         const char* const method, const uint32_t windowSize, const uint32_t hopSize,
+                         Result& result)
+{
+    const bool isTempo = std::strcmp(method, kTempoMethod) == 0;
+    uint64_t allocs = gAllocCount;
+    aubio_pitch_t* const pitchDetector = isTempo ? nullptr
+                                       : new_aubio_pitch(method, windowSize, hopSize, opts.sampleRate);
+    aubio_tempo_t* const tempoDetector = isTempo ? new_aubio_tempo("default", windowSize, hopSize, opts.sampleRate)
+                                       : nullptr;
+    result.allocsCreate = gAllocCount - allocs;
+
+    if (pitchDetector == nullptr && tempoDetector == nullptr)
+        return false;
+
+    // tempo writes the beat position and the onset position
+    fvec_t* const out = new_fvec(2);
+    fvec_t hop;
+    hop.length = hopSize;
+
+    const uint32_t numHops = signal->length / hopSize;
+    uint64_t frames = 0;
+
+    // warm up, so buffers and caches are filled before measuring
+    for (uint32_t i = 0; i < std::min(numHops, windowSize / hopSize + 8); ++i)
+    {
+        hop.data = signal->data + i * hopSize;
+        processHop(pitchDetector, tempoDetector, &hop, out);
+    }
+
+    using clock = std::chrono::steady_clock;
+    const clock::time_point start = clock::now();
+    const uint64_t startCycles = readCycles();
+    allocs = gAllocCount;
+    double elapsed;
+
+    do {
+        for (uint32_t i = 0; i < numHops; ++i)
+        {
+            hop.data = signal->data + i * hopSize;
+            processHop(pitchDetector, tempoDetector, &hop, out);
+        }
+        frames += numHops;
+        elapsed = std::chrono::duration<double>(clock::now() - start).count();
+    } while (elapsed < opts.minSeconds);
+
+    const uint64_t cycles = readCycles() - startCycles;
+
+    result.frames = frames;
+    result.nsPerFrame = elapsed * 1e9 / frames;
+    result.realtimeFactor = (static_cast<double>(frames) * hopSize / opts.sampleRate) / elapsed;
+    result.allocsPerFrame = static_cast<double>(gAllocCount - allocs) / frames;
+#ifdef PITCHBENCH_HAS_CYCLES
+    result.cyclesPerSample = static_cast<double>(cycles) / (static_cast<double>(frames) * hopSize);
+#else
+    result.cyclesPerSample = -1.0;
+    (void)cycles;
+#endif
+
+    del_fvec(out);
+    if (pitchDetector != nullptr)
+        del_aubio_pitch(pitchDetector);
+    if (tempoDetector != nullptr)
+        del_aubio_tempo(tempoDetector);
+    return true;
+}
+
+// -----------------------------------------------------------------------
+
+static void printUsage(const char* const name)
+{
+    std::fprintf(stderr,
+        "usage: %s [options]\n"
+        "\n"
+        "Times aubio_pitch_do for each pitch method, window and hop size, printing CSV rows.\n"
+        "The tempo method times aubio_tempo_do, the beat tracking, instead.\n"
+        "cycles_per_sample is -1 where no cycle counter is available,\n"
+        "allocation counts are -1 where they can not be measured.\n"
+        "\n"
+        "  -m method  only run this method, can be repeated\n"
+        "  -w size    only run this window size, can be repeated\n"
+        "  -r rate    sample rate (default 48000)\n"
+        "  -t secs    minimum measuring time per configuration (default 0.25)\n",
+        name);
+}
+
+int main(int argc, char* argv[])
+{
+    Options opts;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (argv[i][0] != '-' || argv[i][1] == '\0' || argv[i][2] != '\0' || i + 1 >= argc)
+        {
+            printUsage(argv[0]);
+            return 1;
+        }
+
+        const char* const value = argv[++i];
+
+        switch (argv[i - 1][1])
+        {
+        case 'm':
+            opts.methods.push_back(value);
+            break;
+        case 'w':
+            opts.windowSizes.push_back(std::max(2, std::atoi(value)));
+            break;
+        case 'r':
+            opts.sampleRate = std::max(1, std::atoi(value));
+            break;
+        case 't':
+            opts.minSeconds = std::atof(value);
+            break;
+        default:
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (opts.methods.empty())
+        opts.methods.assign(kMethods, kMethods + sizeof(kMethods)/sizeof(kMethods[0]));
+    if (opts.windowSizes.empty())
+        opts.windowSizes.assign(kWindowSizes, kWindowSizes + sizeof(kWindowSizes)/sizeof(kWindowSizes[0]));
+
+    // one second of audio, looped while measuring
+    fvec_t* const signal = createSignal(opts.sampleRate, opts.sampleRate);
+
+    std::printf("method,window,hop,samplerate,frames,ns_per_frame,realtime_factor,"
+                "cycles_per_sample,allocs_create,allocs_per_frame\n");
+
+    int failed = 0;
+
+    for (const std::string& method : opts.methods)
+    {
+        for (const uint32_t windowSize : opts.windowSizes)
+        {
+            for (const uint32_t division : kHopDivisions)
+            {
+                const uint32_t hopSize = windowSize / division;
+                Result r;
+
+                if (! runBenchmark(opts, signal, method.c_str(), windowSize, hopSize, r))
+                {
+                    std::fprintf(stderr, "pitchbench: could not create %s with window %u and hop %u\n",
+                                 method.c_str(), windowSize, hopSize);
+                    ++failed;
+                    continue;
+                }
+
+#ifdef PITCHBENCH_HAS_ALLOC_COUNT
+                std::printf("%s,%u,%u,%u,%llu,%.1f,%.2f,%.2f,%llu,%.4f\n",
+                            method.c_str(), windowSize, hopSize, opts.sampleRate,
+                            static_cast<unsigned long long>(r.frames), r.nsPerFrame, r.realtimeFactor,
+                            r.cyclesPerSample, static_cast<unsigned long long>(r.allocsCreate),
+                            r.allocsPerFrame);
+#else
+                std::printf("%s,%u,%u,%u,%llu,%.1f,%.2f,%.2f,-1,-1\n",
+                            method.c_str(), windowSize, hopSize, opts.sampleRate,
+                            static_cast<unsigned long long>(r.frames), r.nsPerFrame, r.realtimeFactor,
+                            r.cyclesPerSample);
+#endif
+                std::fflush(stdout);
+            }
+        }
+    }
+
+    del_fvec(signal);
+    return failed != 0 ? 1 : 0;
+}
+
+// -----------------------------------------------------------------------
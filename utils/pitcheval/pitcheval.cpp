@@ -0,0 +1,609 @@
+/*
+ * DISTRHO PitchTracking Series
+ * Copyright (C) 2021-2022 Bram Giesen
+ * Copyright (C) 2022 Filipe Coelho <falktx@falktx.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 3 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * For a full copy of the GNU General Public License see the LICENSE file.
+ */
+
+// Accuracy versus cost evaluation of pitch detector configurations.
+// Runs labelled signals (generated or read from disk) through aubio_pitch_t
+// and reports error rates next to CPU cost and note onset latency, so that
+// changes to the pitch path can be checked for quality regressions.
+
+#define AUBIO_UNSTABLE 1
+#include "PitchTracking.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+// -----------------------------------------------------------------------
+
+// an estimate further than this from the reference is a gross error (ratio)
+static constexpr const double kGrossErrorRatio = 0.2;
+
+// an estimate within this many cents of the reference is accurate
+static constexpr const double kStableCents = 50.0;
+
+// number of consecutive accurate frames for a note to count as stable
+static constexpr const uint32_t kStableFrames = 3;
+
+// reference pitch changes larger than this many cents start a new note
+static constexpr const double kOnsetCents = 100.0;
+
+struct Config {
+    std::string name;
+    std::string method;
+    uint32_t windowSize;
+    uint32_t hopSize;
+    float tolerance;  // negative to keep the method default
+    float threshold;  // minimum confidence for a frame to be voiced
+    float gain;       // input gain, like the plugin sensitivity
+    float silence;    // silence threshold, in dB
+};
+
+// a signal with its reference pitch for every sample, 0 where unvoiced
+struct LabelledSignal {
+    std::string name;
+    uint32_t sampleRate;
+    std::vector<float> samples;
+    std::vector<float> reference;
+};
+
+struct Stats {
+    uint64_t frames = 0;
+    uint64_t refVoiced = 0;
+    uint64_t bothVoiced = 0;
+    uint64_t grossErrors = 0;
+    uint64_t octaveErrors = 0;
+    uint64_t voicingErrors = 0;
+    double fineCentsSum = 0.0;
+    uint64_t fineCentsCount = 0;
+    double seconds = 0.0;
+    double audioSeconds = 0.0;
+    uint32_t onsets = 0;
+    uint32_t onsetsMissed = 0;
+    double latencySum = 0.0;
+    double latencyMax = 0.0;
+
+    void add(const Stats& o)
+    {
+        frames += o.frames;
+        refVoiced += o.refVoiced;
+        bothVoiced += o.bothVoiced;
+        grossErrors += o.grossErrors;
+        octaveErrors += o.octaveErrors;
+        voicingErrors += o.voicingErrors;
+        fineCentsSum += o.fineCentsSum;
+        fineCentsCount += o.fineCentsCount;
+        seconds += o.seconds;
+        audioSeconds += o.audioSeconds;
+        onsets += o.onsets;
+        onsetsMissed += o.onsetsMissed;
+        latencySum += o.latencySum;
+        latencyMax = std::max(latencyMax, o.latencyMax);
+    }
+};
+
+// -----------------------------------------------------------------------
+// Synthetic signals
+
+struct Synth {
+    LabelledSignal& sig;
+    double phase = 0.0;
+    uint32_t seed = 1;
+
+    Synth(LabelledSignal& s) : sig(s) {}
+
+    float noise()
+    {
+        seed = seed * 1664525u + 1013904223u;
+        return static_cast<float>(seed >> 8) / 16777216.f * 2.f - 1.f;
+    }
+
+    // append one sample of a harmonic tone, advancing the phase by f0
+    void tone(const double f0, const double amp, const int harmonics, const double brightness,
+              const double noiseAmp, const bool voiced)
+    {
+        double v = 0.0;
+
+        for (int h = 1; h <= harmonics; ++h)
+            v += std::sin(phase * h) * std::pow(brightness, h - 1);
+
+        phase += 2.0 * M_PI * f0 / sig.sampleRate;
+        if (phase > 2.0 * M_PI)
+            phase -= 2.0 * M_PI;
+
+        sig.samples.push_back(static_cast<float>(v * amp + noise() * noiseAmp));
+        sig.reference.push_back(voiced ? static_cast<float>(f0) : 0.f);
+    }
+
+    void silence(const double seconds)
+    {
+        for (uint32_t i = 0, n = seconds * sig.sampleRate; i < n; ++i)
+        {
+            sig.samples.push_back(noise() * 0.0005f);
+            sig.reference.push_back(0.f);
+        }
+    }
+};
+
+static double midiToHz(const double note)
+{
+    return 440.0 * std::pow(2.0, (note - 69.0) / 12.0);
+}
+
+static void generateSignals(const uint32_t sampleRate, std::vector<LabelledSignal>& signals)
+{
+    static const int notes[] = { 45, 52, 57, 60, 64, 69, 72, 76, 81, 48, 55, 40 };
+    const uint32_t numNotes = sizeof(notes)/sizeof(notes[0]);
+
+    // harmonic tones with gaps of silence
+    {
+        LabelledSignal sig = { "tones", sampleRate, {}, {} };
+        Synth s(sig);
+        for (uint32_t n = 0; n < numNotes; ++n)
+        {
+            const double f0 = midiToHz(notes[n]);
+            for (uint32_t i = 0, len = 0.5 * sampleRate; i < len; ++i)
+                s.tone(f0, 0.2, 8, 0.7, 0.001, true);
+            s.silence(0.1);
+        }
+        signals.push_back(sig);
+    }
+
+    // vibrato, +/- 50 cents at 5.5 Hz
+    {
+        LabelledSignal sig = { "vibrato", sampleRate, {}, {} };
+        Synth s(sig);
+        for (const int note : { 57, 64, 69 })
+        {
+            for (uint32_t i = 0, len = 1.5 * sampleRate; i < len; ++i)
+            {
+                const double depth = 0.5 * std::sin(2.0 * M_PI * 5.5 * i / sampleRate);
+                s.tone(midiToHz(note + depth), 0.2, 6, 0.6, 0.001, true);
+            }
+            s.silence(0.1);
+        }
+        signals.push_back(sig);
+    }
+
+    // exponential glides up and down over 3 octaves
+    {
+        LabelledSignal sig = { "glides", sampleRate, {}, {} };
+        Synth s(sig);
+        for (uint32_t i = 0, len = 3 * sampleRate; i < len; ++i)
+            s.tone(midiToHz(40 + 36.0 * i / len), 0.2, 6, 0.6, 0.001, true);
+        for (uint32_t i = 0, len = 3 * sampleRate; i < len; ++i)
+            s.tone(midiToHz(76 - 36.0 * i / len), 0.2, 6, 0.6, 0.001, true);
+        signals.push_back(sig);
+    }
+
+    // guitar-like plucks: noise burst, bright decaying harmonics, unvoiced once decayed
+    {
+        LabelledSignal sig = { "plucks", sampleRate, {}, {} };
+        Synth s(sig);
+        for (uint32_t n = 0; n < numNotes; ++n)
+        {
+            const double f0 = midiToHz(notes[n]);
+            for (uint32_t i = 0, len = 0.8 * sampleRate; i < len; ++i)
+            {
+                const double t = static_cast<double>(i) / sampleRate;
+                const double env = std::exp(-t * 5.0);
+                const double burst = t < 0.01 ? 0.2 * (1.0 - t / 0.01) : 0.0;
+                s.tone(f0, 0.3 * env, 12, 0.5 + 0.3 * env, 0.003 + burst, env > 0.01);
+            }
+        }
+        signals.push_back(sig);
+    }
+
+    // octave jumps
+    {
+        LabelledSignal sig = { "octaves", sampleRate, {}, {} };
+        Synth s(sig);
+        static const int jumps[] = { 45, 57, 69, 57, 45, 33, 45, 69, 45 };
+        for (const int note : jumps)
+            for (uint32_t i = 0, len = 0.4 * sampleRate; i < len; ++i)
+                s.tone(midiToHz(note), 0.2, 6, 0.6, 0.001, true);
+        signals.push_back(sig);
+    }
+}
+
+// -----------------------------------------------------------------------
+// Recorded corpora, a wav file with a "time,f0" csv file next to it
+
+static bool loadLabelledFile(const char* const wavPath, LabelledSignal& sig)
+{
+    std::string labelPath(wavPath);
+    const std::string::size_type ext = labelPath.find_last_of('.');
+    if (ext != std::string::npos)
+        labelPath.resize(ext);
+    labelPath += ".f0.csv";
+
+    FILE* const labels = std::fopen(labelPath.c_str(), "r");
+    if (labels == nullptr)
+    {
+        std::fprintf(stderr, "pitcheval: could not open labels %s\n", labelPath.c_str());
+        return false;
+    }
+
+    std::vector<std::pair<double, float> > points;
+    char line[256];
+    while (std::fgets(line, sizeof(line), labels) != nullptr)
+    {
+        double time;
+        float f0;
+        // skips comments and headers
+        if (std::sscanf(line, "%lf,%f", &time, &f0) == 2)
+            points.push_back(std::make_pair(time, f0));
+    }
+    std::fclose(labels);
+
+    const uint32_t hopSize = 4096;
+    aubio_source_wavread_t* const source = new_aubio_source_wavread(wavPath, 0, hopSize);
+    if (source == nullptr)
+        return false;
+
+    sig.name = wavPath;
+    sig.sampleRate = aubio_source_wavread_get_samplerate(source);
+
+    fvec_t* const buf = new_fvec(hopSize);
+    uint_t read = 0;
+    do {
+        aubio_source_wavread_do(source, buf, &read);
+        sig.samples.insert(sig.samples.end(), buf->data, buf->data + read);
+    } while (read == hopSize);
+    del_fvec(buf);
+    del_aubio_source_wavread(source);
+
+    // labels hold their value until the next point
+    sig.reference.resize(sig.samples.size());
+    size_t p = 0;
+    for (size_t i = 0; i < sig.samples.size(); ++i)
+    {
+        const double t = static_cast<double>(i) / sig.sampleRate;
+        while (p + 1 < points.size() && points[p + 1].first <= t)
+            ++p;
+        sig.reference[i] = (! points.empty() && points[p].first <= t) ? points[p].second : 0.f;
+    }
+
+    return true;
+}
+
+// -----------------------------------------------------------------------
+
+static double centsBetween(const double f, const double ref)
+{
+    return 1200.0 * std::log2(f / ref);
+}
+
+static bool evaluate(const Config& cfg, const LabelledSignal& sig, Stats& stats)
+{
+    aubio_pitch_t* const pitchDetector = new_aubio_pitch(cfg.method.c_str(), cfg.windowSize, cfg.hopSize,
+                                                         sig.sampleRate);
+    if (pitchDetector == nullptr)
+        return false;
+
+    aubio_pitch_set_unit(pitchDetector, "Hz");
+    aubio_pitch_set_silence(pitchDetector, cfg.silence);
+    if (cfg.tolerance >= 0.f)
+        aubio_pitch_set_tolerance(pitchDetector, cfg.tolerance);
+
+    const uint32_t numFrames = sig.samples.size() / cfg.hopSize;
+    std::vector<float> pitches(numFrames), confidences(numFrames);
+
+    fvec_t* const hop = new_fvec(cfg.hopSize);
+    fvec_t* const out = new_fvec(1);
+    double seconds = 0.0;
+
+    for (uint32_t f = 0; f < numFrames; ++f)
+    {
+        for (uint32_t i = 0; i < cfg.hopSize; ++i)
+            hop->data[i] = sig.samples[f * cfg.hopSize + i] * cfg.gain;
+
+        const auto start = std::chrono::steady_clock::now();
+        aubio_pitch_do(pitchDetector, hop, out);
+        seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        pitches[f] = out->data[0];
+        confidences[f] = aubio_pitch_get_confidence(pitchDetector);
+    }
+
+    // pyin decides on older frames, accuracy is measured on the frame each estimate belongs to
+    const uint32_t lag = aubio_pitch_get_lag(pitchDetector);
+
+    del_fvec(out);
+    del_fvec(hop);
+    del_aubio_pitch(pitchDetector);
+
+    stats.frames = numFrames;
+    stats.seconds = seconds;
+    stats.audioSeconds = static_cast<double>(numFrames) * cfg.hopSize / sig.sampleRate;
+
+    // frame f covers the window ending at (f+1)*hop, compared against the reference at its center
+    std::vector<bool> accurate(numFrames);
+
+    for (uint32_t f = 0; f < numFrames; ++f)
+    {
+        const int64_t end = static_cast<int64_t>(f + 1) * cfg.hopSize;
+        const int64_t center = std::max<int64_t>(0, end - cfg.windowSize / 2);
+        const float ref = sig.reference[center];
+        const float est = f + lag < numFrames ? pitches[f + lag] : 0.f;
+        const bool refVoiced = ref > 0.f;
+        const bool estVoiced = est > 0.f && confidences[std::min(f + lag, numFrames - 1)] >= cfg.threshold;
+
+        if (refVoiced != estVoiced)
+            ++stats.voicingErrors;
+
+        // latency is measured against the current reference, once the whole window is known
+        const float current = sig.reference[end - 1];
+        accurate[f] = pitches[f] > 0.f && confidences[f] >= cfg.threshold
+                   && current > 0.f && std::abs(centsBetween(pitches[f], current)) <= kStableCents;
+
+        if (! refVoiced)
+            continue;
+
+        ++stats.refVoiced;
+
+        if (! estVoiced)
+            continue;
+
+        ++stats.bothVoiced;
+
+        const double cents = centsBetween(est, ref);
+
+        if (std::abs(est / ref - 1.0) > kGrossErrorRatio)
+        {
+            ++stats.grossErrors;
+
+            // octave errors are gross errors close to a whole number of octaves
+            const double octaves = std::abs(cents) / 1200.0;
+            if (std::abs(cents) >= 1100.0 && std::abs(octaves - std::round(octaves)) * 1200.0 <= 100.0)
+                ++stats.octaveErrors;
+        }
+        else
+        {
+            stats.fineCentsSum += std::abs(cents);
+            ++stats.fineCentsCount;
+        }
+    }
+
+    // onsets are reference changes from unvoiced to voiced, or between notes
+    std::vector<uint32_t> onsets;
+    for (size_t i = 1; i < sig.reference.size(); ++i)
+    {
+        const float prev = sig.reference[i - 1], cur = sig.reference[i];
+        if (cur > 0.f && (prev <= 0.f || std::abs(centsBetween(cur, prev)) > kOnsetCents))
+            onsets.push_back(i);
+    }
+    if (! sig.reference.empty() && sig.reference[0] > 0.f)
+        onsets.insert(onsets.begin(), 0);
+
+    for (size_t o = 0; o < onsets.size(); ++o)
+    {
+        const uint64_t onset = onsets[o];
+        const uint64_t next = o + 1 < onsets.size() ? onsets[o + 1] : sig.reference.size();
+        uint64_t runStart = 0;
+        uint32_t run = 0;
+        bool found = false;
+
+        ++stats.onsets;
+
+        for (uint32_t f = onset / cfg.hopSize; f < numFrames; ++f)
+        {
+            const uint64_t end = static_cast<uint64_t>(f + 1) * cfg.hopSize;
+            if (end <= onset)
+                continue;
+            // a stable run has to start before the next note
+            if (run == 0 && end > next)
+                break;
+
+            if (! accurate[f])
+            {
+                run = 0;
+                continue;
+            }
+
+            if (run++ == 0)
+                runStart = end;
+
+            if (run == kStableFrames)
+            {
+                const double latency = static_cast<double>(runStart - onset) / sig.sampleRate;
+                stats.latencySum += latency;
+                stats.latencyMax = std::max(stats.latencyMax, latency);
+                found = true;
+                break;
+            }
+        }
+
+        if (! found)
+            ++stats.onsetsMissed;
+    }
+
+    return true;
+}
+
+static void printStats(const Config& cfg, const std::string& signal, const Stats& s)
+{
+    const double both = std::max<uint64_t>(1, s.bothVoiced);
+    const uint32_t stable = s.onsets - s.onsetsMissed;
+
+    std::printf("%s,%s,%u,%u,%s,%llu,%.2f,%.2f,%.2f,%.2f,%.1f,%.1f,%.2f,%u,%u,%.1f,%.1f\n",
+                cfg.name.c_str(), cfg.method.c_str(), cfg.windowSize, cfg.hopSize, signal.c_str(),
+                static_cast<unsigned long long>(s.frames),
+                100.0 * s.grossErrors / both,
+                100.0 * s.octaveErrors / both,
+                100.0 * s.voicingErrors / std::max<uint64_t>(1, s.frames),
+                s.fineCentsCount ? s.fineCentsSum / s.fineCentsCount : 0.0,
+                s.seconds * 1e9 / std::max<uint64_t>(1, s.frames),
+                s.seconds > 0.0 ? s.audioSeconds / s.seconds : 0.0,
+                100.0 * s.bothVoiced / std::max<uint64_t>(1, s.refVoiced),
+                s.onsets, s.onsetsMissed,
+                stable ? 1000.0 * s.latencySum / stable : 0.0,
+                1000.0 * s.latencyMax);
+}
+
+// -----------------------------------------------------------------------
+
+static bool parseConfig(const char* const arg, Config& cfg)
+{
+    char method[32];
+    unsigned windowSize, hopSize;
+    float tolerance = -1.f, threshold = 0.f;
+
+    const int n = std::sscanf(arg, "%31[^:]:%u:%u:%f:%f", method, &windowSize, &hopSize, &tolerance, &threshold);
+    if (n < 3 || hopSize == 0 || windowSize < hopSize)
+        return false;
+
+    cfg = { arg, method, windowSize, hopSize, tolerance, threshold, 1.f, -50.f };
+    return true;
+}
+
+static void printUsage(const char* const name)
+{
+    std::fprintf(stderr,
+        "usage: %s [options] [file.wav ...]\n"
+        "\n"
+        "Evaluates pitch detector configurations on generated signals (tones, vibrato, glides,\n"
+        "plucks and octave jumps) and on labelled wav files, printing CSV rows per configuration\n"
+        "and signal, plus an 'all' row per configuration.\n"
+        "Labels for file.wav are read from file.f0.csv, as 'time,f0' lines in seconds and Hz,\n"
+        "with f0 set to 0 where unvoiced. Each value holds until the next line.\n"
+        "\n"
+        "  -c config  method:window:hop[:tolerance[:threshold]], can be repeated\n"
+        "             (default is the plugin method on full buffers, with the plugin default\n"
+        "             tolerance, threshold and sensitivity, and each method with 2048:512)\n"
+        "  -n         do not use the generated signals\n"
+        "  -r rate    sample rate of generated signals (default 48000)\n"
+        "\n"
+        "Columns: gpe is the gross pitch error rate (more than %.0f%% off) and octave the rate\n"
+        "of octave errors, both over frames voiced in reference and estimate. vde is the voicing\n"
+        "decision error rate over all frames, cents the mean error of non-gross estimates and\n"
+        "recall the rate of reference voiced frames detected as voiced. Latency goes from a note\n"
+        "onset to the first of %u consecutive frames within %.0f cents, notes never getting there\n"
+        "are counted as missed.\n",
+        name, kGrossErrorRatio * 100.0, kStableFrames, kStableCents);
+}
+
+int main(int argc, char* argv[])
+{
+    std::vector<Config> configs;
+    std::vector<LabelledSignal> signals;
+    uint32_t sampleRate = 48000;
+    bool generate = true;
+    int i = 1;
+
+    for (; i < argc && argv[i][0] == '-' && argv[i][1] != '\0'; ++i)
+    {
+        if (argv[i][1] == 'n' && argv[i][2] == '\0')
+        {
+            generate = false;
+            continue;
+        }
+        if (argv[i][2] != '\0' || i + 1 >= argc)
+        {
+            printUsage(argv[0]);
+            return 1;
+        }
+
+        const char opt = argv[i][1];
+        const char* const value = argv[++i];
+        Config cfg;
+
+        switch (opt)
+        {
+        case 'c':
+            if (! parseConfig(value, cfg))
+            {
+                printUsage(argv[0]);
+                return 1;
+            }
+            configs.push_back(cfg);
+            break;
+        case 'r':
+            sampleRate = std::max(1, std::atoi(value));
+            break;
+        default:
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (configs.empty())
+    {
+        // the plugin method on whole non-overlapping buffers, scaled by the default sensitivity.
+        // this is only its main detector, without fast attack, adaptive windows, pre-filter,
+        // pitch range or output smoothing, see pitchlatency for the plugin itself
+        configs.push_back({ std::string(kAubioMethod) + "-full", kAubioMethod, kAubioBufferSize, kAubioBufferSize,
+                            kDefaultTolerance * 0.01f, kDefaultThreshold * 0.01f,
+                            kDefaultSensitivity, kAubioSilence });
+
+        for (const char* const method : { "yin", "yinfast", "yinfft", "mcomb", "fcomb", "schmitt", "specacf", "dual", "pyin" })
+            configs.push_back({ std::string(method) + ":2048:512", method, 2048, 512, -1.f, 0.f, 1.f, -50.f });
+    }
+
+    if (generate)
+        generateSignals(sampleRate, signals);
+
+    for (; i < argc; ++i)
+    {
+        LabelledSignal sig;
+        if (! loadLabelledFile(argv[i], sig))
+            return 1;
+        signals.push_back(sig);
+    }
+
+    if (signals.empty())
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    std::printf("config,method,window,hop,signal,frames,gpe,octave,vde,cents,ns_per_frame,"
+                "realtime_factor,recall,onsets,missed,latency_mean_ms,latency_max_ms\n");
+
+    int failed = 0;
+
+    for (const Config& cfg : configs)
+    {
+        Stats total;
+
+        for (const LabelledSignal& sig : signals)
+        {
+            Stats stats;
+
+            if (! evaluate(cfg, sig, stats))
+            {
+                std::fprintf(stderr, "pitcheval: could not run %s on %s\n", cfg.name.c_str(), sig.name.c_str());
+                ++failed;
+                continue;
+            }
+
+            printStats(cfg, sig.name, stats);
+            total.add(stats);
+        }
+
+        printStats(cfg, "all", total);
+        std::fflush(stdout);
+    }
+
+    return failed != 0 ? 1 : 0;
+}
+
+// -----------------------------------------------------------------------
@@ -0,0 +1,370 @@
+/*
+ * DISTRHO PitchTracking Series
+ * Copyright (C) 2021-2022 Bram Giesen
+ * Copyright (C) 2022 Filipe Coelho <falktx@falktx.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 3 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * For a full copy of the GNU General Public License see the LICENSE file.
+ */
+
+// End-to-end latency of the AudioToCVPitch plugin.
+// Instantiates the plugin as a host would, feeds it scripted note sequences
+// in blocks of different sizes and measures how long it takes for the gate
+// to open or close and for the pitch output to settle after each change.
+
+// build the plugin and the DPF plugin base class into this executable
+#include "src/DistrhoPlugin.cpp"
+#include "AudioToCVPitch.cpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+START_NAMESPACE_DISTRHO
+
+// -----------------------------------------------------------------------
+
+// the pitch output has settled when within this many cents of the note
+static constexpr const float kSettleCents = 50.f;
+
+// gate level above which the gate is considered open
+static constexpr const float kGateThreshold = 5.f;
+
+static const float kTolerances[] = { 2.f, kDefaultTolerance, 15.f, 30.f };
+static const float kThresholds[] = { 0.f, kDefaultThreshold, 50.f };
+static const uint32_t kBlockSizes[] = { 32, 128, 512, 2048 };
+
+enum EventType {
+    kEventAttack,
+    kEventRelease,
+    kEventChange,
+    kEventTypeCount
+};
+
+static const char* const kEventTypeNames[kEventTypeCount] = { "attack", "release", "change" };
+
+// a note (or silence when midi note is < 0) starting at a given time
+struct ScriptEvent {
+    double time;
+    int note;
+};
+
+struct Measurement {
+    std::vector<double> latencies[kEventTypeCount];
+    // the same latencies minus the latency the plugin reported when each event started
+    std::vector<double> compensated[kEventTypeCount];
+    std::vector<double> reported;
+    uint32_t missed[kEventTypeCount] = {};
+};
+
+// -----------------------------------------------------------------------
+
+// notes spread over guitar and bass range, with releases and direct note changes
+static std::vector<ScriptEvent> createScript()
+{
+    static const int notes[] = { 40, 45, 52, 57, 64, 69, 76, 81, 47, 59, 71, 43 };
+    std::vector<ScriptEvent> script;
+    double time = 0.25;
+
+    for (const int note : notes)
+    {
+        // attack from silence, then change to a neighbour note, then release
+        script.push_back({ time, note });
+        script.push_back({ time + 0.5, note + 5 });
+        script.push_back({ time + 1.0, -1 });
+        time += 1.4;
+    }
+
+    script.push_back({ time, -1 });
+    return script;
+}
+
+static std::vector<float> renderScript(const std::vector<ScriptEvent>& script, const double sampleRate)
+{
+    const uint32_t length = script.back().time * sampleRate;
+    std::vector<float> audio(length, 0.f);
+    double phase = 0.0;
+
+    for (size_t e = 0; e + 1 < script.size(); ++e)
+    {
+        if (script[e].note < 0)
+            continue;
+
+        const double f0 = 440.0 * std::pow(2.0, (script[e].note - 69) / 12.0);
+        const uint32_t start = script[e].time * sampleRate;
+        const uint32_t end = std::min<uint32_t>(length, script[e + 1].time * sampleRate);
+
+        for (uint32_t i = start; i < end; ++i)
+        {
+            // short fades to avoid clicks at note boundaries
+            const double fade = std::min(1.0, std::min(i - start, end - i) / (0.002 * sampleRate));
+            double v = 0.0;
+
+            for (int h = 1; h <= 6; ++h)
+                v += std::sin(phase * h) / h;
+
+            // keep the phase continuous on note changes, like a real instrument would
+            phase += 2.0 * M_PI * f0 / sampleRate;
+            if (phase > 2.0 * M_PI)
+                phase -= 2.0 * M_PI;
+
+            audio[i] = static_cast<float>(v * 0.1 * fade);
+        }
+    }
+
+    return audio;
+}
+
+// -----------------------------------------------------------------------
+
+// PluginExporter gained an extra callback argument in newer DPF versions
+template <class Exporter>
+static auto createExporter(int) -> decltype(new Exporter(nullptr, nullptr, nullptr, nullptr))
+{
+    return new Exporter(nullptr, nullptr, nullptr, nullptr);
+}
+
+template <class Exporter>
+static Exporter* createExporter(long)
+{
+    return new Exporter(nullptr, nullptr, nullptr);
+}
+
+static uint32_t findParameter(const PluginExporter& plugin, const char* const symbol)
+{
+    for (uint32_t i = 0, count = plugin.getParameterCount(); i < count; ++i)
+    {
+        if (plugin.getParameterSymbol(i) == symbol)
+            return i;
+    }
+
+    d_stderr2("pitchlatency: plugin has no '%s' parameter", symbol);
+    std::exit(1);
+    return 0;
+}
+
+static void measure(const std::vector<ScriptEvent>& script, const std::vector<float>& audio,
+                        const double sampleRate, const uint32_t blockSize,
+                        const float tolerance, const float threshold, const float windowPeriods,
+                        Measurement& result)
+{
+    d_nextBufferSize = blockSize;
+    d_nextSampleRate = sampleRate;
+
+    PluginExporter* const plugin = createExporter<PluginExporter>(0);
+
+    plugin->setParameterValue(findParameter(*plugin, "Tolerance"), tolerance);
+    plugin->setParameterValue(findParameter(*plugin, "ConfidenceThreshold"), threshold);
+    plugin->setParameterValue(findParameter(*plugin, "WindowPeriods"), windowPeriods);
+    plugin->activate();
+
+    const uint32_t length = audio.size();
+    std::vector<float> pitch(length), gate(length);
+    // the reported latency may change during the script, keep the one in use at the start of each event
+    std::vector<uint32_t> eventLatencies(script.size());
+    size_t nextEvent = 0;
+    // only the pitch and gate outputs are measured
+    std::vector<float> unused((DISTRHO_PLUGIN_NUM_OUTPUTS - 2) * blockSize);
+
+    for (uint32_t pos = 0; pos < length; pos += blockSize)
+    {
+        const uint32_t frames = std::min(blockSize, length - pos);
+        const float* inputs[1] = { audio.data() + pos };
+        float* outputs[DISTRHO_PLUGIN_NUM_OUTPUTS] = { pitch.data() + pos, gate.data() + pos };
+        for (uint32_t o = 2; o < DISTRHO_PLUGIN_NUM_OUTPUTS; ++o)
+            outputs[o] = unused.data() + (o - 2) * blockSize;
+
+        for (; nextEvent < script.size() && script[nextEvent].time * sampleRate < pos + frames; ++nextEvent)
+            eventLatencies[nextEvent] = plugin->getLatency();
+
+        plugin->run(inputs, outputs, frames);
+    }
+
+    plugin->deactivate();
+    delete plugin;
+
+    // the latency of an event is the time until outputs reach their new state and stay there
+    for (size_t e = 0; e + 1 < script.size(); ++e)
+    {
+        const uint32_t start = script[e].time * sampleRate;
+        const uint32_t end = std::min<uint32_t>(length, script[e + 1].time * sampleRate);
+        const bool noteOn = script[e].note >= 0;
+        const EventType type = ! noteOn ? kEventRelease
+                             : (e > 0 && script[e - 1].note >= 0) ? kEventChange : kEventAttack;
+        const float expectedCV = noteOn ? pitchInHzToCV(440.f * std::pow(2.f, (script[e].note - 69) / 12.f), 0) : 0.f;
+
+        uint32_t settled = end;
+
+        for (uint32_t i = end; i-- > start;)
+        {
+            const bool gateOpen = gate[i] >= kGateThreshold;
+            const bool ok = noteOn ? gateOpen && std::abs(pitch[i] - expectedCV) * 1200.f <= kSettleCents
+                                   : ! gateOpen;
+            if (! ok)
+                break;
+
+            settled = i;
+        }
+
+        const double reported = eventLatencies[e] / sampleRate;
+        result.reported.push_back(reported);
+
+        if (settled == end)
+        {
+            ++result.missed[type];
+            continue;
+        }
+
+        const double latency = static_cast<double>(settled - start) / sampleRate;
+        result.latencies[type].push_back(latency);
+        result.compensated[type].push_back(latency - reported);
+    }
+}
+
+static void printLatencies(const char* const label, std::vector<double> values)
+{
+    if (values.empty())
+    {
+        std::printf(",%s,-1,-1,-1,-1", label);
+        return;
+    }
+
+    std::sort(values.begin(), values.end());
+
+    double sum = 0.0;
+    for (const double v : values)
+        sum += v;
+
+    const size_t n = values.size();
+    std::printf(",%s,%.2f,%.2f,%.2f,%.2f", label,
+                1000.0 * sum / n,
+                1000.0 * values[n / 2],
+                1000.0 * values[std::min(n - 1, n * 9 / 10)],
+                1000.0 * values[n - 1]);
+}
+
+// -----------------------------------------------------------------------
+
+END_NAMESPACE_DISTRHO
+
+USE_NAMESPACE_DISTRHO
+
+static void printUsage(const char* const name)
+{
+    std::fprintf(stderr,
+        "usage: %s [options]\n"
+        "\n"
+        "Measures attack, release and note change latency of the AudioToCVPitch plugin\n"
+        "for combinations of tolerance, confidence threshold and host block size.\n"
+        "Prints one CSV row per combination and event type, with mean, median, 90th percentile\n"
+        "and maximum latency in ms, raw and compensated for the latency the plugin reported\n"
+        "at the start of each event, and the mean reported latency.\n"
+        "\n"
+        "  -r rate    sample rate (default 48000)\n"
+        "  -b frames  only use this block size, can be repeated\n"
+        "  -t value   only use this tolerance, in %%, can be repeated\n"
+        "  -c value   only use this confidence threshold, in %%, can be repeated\n"
+        "  -p value   window periods, 0 to always analyse the full buffer (default %d)\n",
+        name, kDefaultWindowPeriods);
+}
+
+int main(int argc, char* argv[])
+{
+    double sampleRate = 48000.0;
+    float windowPeriods = kDefaultWindowPeriods;
+    std::vector<uint32_t> blockSizes;
+    std::vector<float> tolerances, thresholds;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (argv[i][0] != '-' || argv[i][1] == '\0' || argv[i][2] != '\0' || i + 1 >= argc)
+        {
+            printUsage(argv[0]);
+            return 1;
+        }
+
+        const char opt = argv[i][1];
+        const char* const value = argv[++i];
+
+        switch (opt)
+        {
+        case 'r':
+            sampleRate = std::max(1000.0, std::atof(value));
+            break;
+        case 'b':
+            blockSizes.push_back(std::max(1, std::atoi(value)));
+            break;
+        case 't':
+            tolerances.push_back(std::atof(value));
+            break;
+        case 'c':
+            thresholds.push_back(std::atof(value));
+            break;
+        case 'p':
+            windowPeriods = std::max(0, std::atoi(value));
+            break;
+        default:
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (blockSizes.empty())
+        blockSizes.assign(kBlockSizes, kBlockSizes + sizeof(kBlockSizes)/sizeof(kBlockSizes[0]));
+    if (tolerances.empty())
+        tolerances.assign(kTolerances, kTolerances + sizeof(kTolerances)/sizeof(kTolerances[0]));
+    if (thresholds.empty())
+        thresholds.assign(kThresholds, kThresholds + sizeof(kThresholds)/sizeof(kThresholds[0]));
+
+    const std::vector<ScriptEvent> script(createScript());
+    const std::vector<float> audio(renderScript(script, sampleRate));
+
+    std::printf("tolerance,threshold,block,mean_reported_latency_ms,event,count,missed,"
+                "raw,mean_ms,median_ms,p90_ms,max_ms,"
+                "compensated,mean_ms,median_ms,p90_ms,max_ms\n");
+
+    for (const float tolerance : tolerances)
+    {
+        for (const float threshold : thresholds)
+        {
+            for (const uint32_t blockSize : blockSizes)
+            {
+                Measurement m;
+                measure(script, audio, sampleRate, blockSize, tolerance, threshold, windowPeriods, m);
+
+                double reportedSum = 0.0;
+                for (const double reported : m.reported)
+                    reportedSum += reported;
+                const double reportedMean = m.reported.empty() ? 0.0 : reportedSum / m.reported.size();
+
+                for (int type = 0; type < kEventTypeCount; ++type)
+                {
+                    std::printf("%.2f,%.2f,%u,%.2f,%s,%u,%u", tolerance, threshold, blockSize,
+                                1000.0 * reportedMean, kEventTypeNames[type],
+                                static_cast<uint32_t>(m.latencies[type].size() + m.missed[type]),
+                                m.missed[type]);
+                    printLatencies("raw", m.latencies[type]);
+                    printLatencies("compensated", m.compensated[type]);
+                    std::printf("\n");
+                }
+
+                std::fflush(stdout);
+            }
+        }
+    }
+
+    return 0;
+}
+
+// -----------------------------------------------------------------------
@@ -0,0 +1,153 @@
+/*
+ * DISTRHO PitchTracking Series
+ * Copyright (C) 2021-2022 Bram Giesen
+ * Copyright (C) 2022 Filipe Coelho <falktx@falktx.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 3 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * For a full copy of the GNU General Public License see the LICENSE file.
+ */
+
+// Check of aubio_pitch_do_multi for every pitch method.
+// Two different signals are analysed one after the other, on one thread and
+// on several, and each call must give the same tracks as a new detector does.
+// Prints one line per method and exits with an error if any track differs.
+
+#include "PitchTracking.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+// -----------------------------------------------------------------------
+
+static const char* const kMethods[] = {
+    "yin", "yinfast", "yinfft", "mcomb", "fcomb", "schmitt", "specacf", "dual", "pyin"
+};
+
+static constexpr const uint32_t kSampleRate = 48000;
+static constexpr const uint32_t kBufferSize = 2048;
+static constexpr const uint32_t kHopSize = 256;
+static constexpr const uint32_t kThreads = 4;
+static constexpr const uint32_t kSignalLength = kSampleRate * 4;
+
+// a tone gliding between two pitches, over some noise, and silent for a while in the middle
+static std::vector<float> createSignal(const double fromHz, const double toHz, uint32_t seed)
+{
+    std::vector<float> signal(kSignalLength);
+    double phase = 0.0;
+
+    for (uint32_t i = 0; i < kSignalLength; ++i)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        const double noise = (seed >> 8) * (1.0 / (1u << 24)) - 0.5;
+        const double t = static_cast<double>(i) / kSignalLength;
+        const bool silent = t > 0.45 && t < 0.55;
+
+        phase += 2.0 * M_PI * (fromHz + (toHz - fromHz) * t) / kSampleRate;
+        signal[i] = silent ? 0.f : static_cast<float>(0.3 * std::sin(phase) + 0.1 * std::sin(2.0 * phase) + 0.02 * noise);
+    }
+
+    return signal;
+}
+
+struct Tracks {
+    std::vector<float> pitch, confidence;
+};
+
+// analyse the signals one after the other with the same detector
+static bool analyse(const char* const method, const uint32_t threads,
+                    const std::vector<float>* const signals[], const uint32_t count, Tracks results[])
+{
+    aubio_pitch_t* const pitch = new_aubio_pitch(method, kBufferSize, kHopSize, kSampleRate);
+
+    if (pitch == nullptr)
+        return false;
+
+    aubio_pitch_set_threads(pitch, threads);
+
+    for (uint32_t s = 0; s < count; ++s)
+    {
+        const uint32_t nframes = signals[s]->size() / kHopSize;
+        fvec_t in, out, conf;
+
+        results[s].pitch.assign(nframes, 0.f);
+        results[s].confidence.assign(nframes, 0.f);
+
+        in.data = const_cast<float*>(signals[s]->data());
+        in.length = signals[s]->size();
+        out.data = results[s].pitch.data();
+        out.length = nframes;
+        conf.data = results[s].confidence.data();
+        conf.length = nframes;
+
+        aubio_pitch_do_multi(pitch, &in, kHopSize, &out, &conf);
+    }
+
+    del_aubio_pitch(pitch);
+    return true;
+}
+
+static uint32_t countDifferences(const Tracks& a, const Tracks& b)
+{
+    uint32_t differences = 0;
+
+    for (size_t i = 0; i < a.pitch.size(); ++i)
+    {
+        if (std::memcmp(&a.pitch[i], &b.pitch[i], sizeof(float)) != 0
+            || std::memcmp(&a.confidence[i], &b.confidence[i], sizeof(float)) != 0)
+            ++differences;
+    }
+
+    return differences;
+}
+
+// -----------------------------------------------------------------------
+
+int main()
+{
+    const std::vector<float> first(createSignal(110.0, 440.0, 1));
+    const std::vector<float> second(createSignal(660.0, 82.0, 2));
+    const std::vector<float>* const both[2] = { &first, &second };
+    int ret = 0;
+
+    std::printf("method,serial_vs_threaded,first_vs_new,second_vs_new,result\n");
+
+    for (const char* const method : kMethods)
+    {
+        Tracks serial[2], threaded[2], fresh[2];
+
+        // each signal on its own detector, which has analysed nothing before
+        if (! analyse(method, 1, both, 2, serial)
+            || ! analyse(method, kThreads, both, 2, threaded)
+            || ! analyse(method, 1, both, 1, &fresh[0])
+            || ! analyse(method, 1, both + 1, 1, &fresh[1]))
+        {
+            std::printf("%s,-1,-1,-1,error\n", method);
+            ret = 1;
+            continue;
+        }
+
+        const uint32_t threadedDiff = countDifferences(serial[0], threaded[0]) + countDifferences(serial[1], threaded[1]);
+        const uint32_t firstDiff = countDifferences(serial[0], fresh[0]) + countDifferences(threaded[0], fresh[0]);
+        const uint32_t secondDiff = countDifferences(serial[1], fresh[1]) + countDifferences(threaded[1], fresh[1]);
+        const bool ok = threadedDiff == 0 && firstDiff == 0 && secondDiff == 0;
+
+        std::printf("%s,%u,%u,%u,%s\n", method, threadedDiff, firstDiff, secondDiff, ok ? "ok" : "FAILED");
+
+        if (! ok)
+            ret = 1;
+    }
+
+    return ret;
+}
+
+// -----------------------------------------------------------------------
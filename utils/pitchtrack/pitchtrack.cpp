@@ -0,0 +1,334 @@
+/*
+ * DISTRHO PitchTracking Series
+ * Copyright (C) 2021-2022 Bram Giesen
+ * Copyright (C) 2022 Filipe Coelho <falktx@falktx.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 3 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * For a full copy of the GNU General Public License see the LICENSE file.
+ */
+
+// Offline version of the AudioToCVPitch plugin.
+// Runs WAV files through the same detector setup and writes the resulting
+// pitch, confidence, CV pitch and gate tracks, one row per analysis frame.
+
+#define AUBIO_UNSTABLE 1
+#include "PitchTracking.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+// -----------------------------------------------------------------------
+
+// read files through a memory mapping where possible
+#ifndef _WIN32
+typedef aubio_source_wavmmap_t aubio_wav_source_t;
+# define new_aubio_wav_source new_aubio_source_wavmmap
+# define del_aubio_wav_source del_aubio_source_wavmmap
+# define aubio_wav_source_do aubio_source_wavmmap_do
+# define aubio_wav_source_get_samplerate aubio_source_wavmmap_get_samplerate
+#else
+typedef aubio_source_wavread_t aubio_wav_source_t;
+# define new_aubio_wav_source new_aubio_source_wavread
+# define del_aubio_wav_source del_aubio_source_wavread
+# define aubio_wav_source_do aubio_source_wavread_do
+# define aubio_wav_source_get_samplerate aubio_source_wavread_get_samplerate
+#endif
+
+// -----------------------------------------------------------------------
+
+// number of analysis frames read from disk at once (about 30s at 48kHz)
+static constexpr const uint32_t kFramesPerSegment = 1024;
+
+enum OutputFormat {
+    kOutputCSV,
+    kOutputBinary
+};
+
+struct Options {
+    float sensitivity = kDefaultSensitivity;
+    float threshold = kDefaultThreshold * 0.01f;
+    float tolerance = kDefaultTolerance * 0.01f;
+    int octave = kDefaultOctave;
+    bool holdOutputPitch = kDefaultHoldOutputPitch;
+    OutputFormat format = kOutputCSV;
+    const char* outputDir = nullptr;
+    uint32_t fileThreads = 0;
+    uint32_t segmentThreads = 0;
+};
+
+// -----------------------------------------------------------------------
+
+static std::string getOutputPath(const Options& opts, const char* const inputPath)
+{
+    std::string path(inputPath);
+
+    if (opts.outputDir != nullptr)
+    {
+        const std::string::size_type sep = path.find_last_of("/\\");
+
+        if (sep != std::string::npos)
+            path = path.substr(sep + 1);
+
+        path = std::string(opts.outputDir) + "/" + path;
+    }
+
+    const std::string::size_type ext = path.find_last_of('.');
+
+    if (ext != std::string::npos && path.find_first_of("/\\", ext) == std::string::npos)
+        path.resize(ext);
+
+    return path + (opts.format == kOutputCSV ? ".csv" : ".bin");
+}
+
+static bool processFile(const Options& opts, const char* const inputPath)
+{
+    const uint32_t segmentSize = kAubioBufferSize * kFramesPerSegment;
+
+    aubio_wav_source_t* const source = new_aubio_wav_source(inputPath, 0, segmentSize);
+
+    if (source == nullptr)
+        return false;
+
+    const uint32_t sampleRate = aubio_wav_source_get_samplerate(source);
+    aubio_pitch_t* const pitchDetector = createAubioPitchDetector(sampleRate, opts.tolerance);
+
+    if (pitchDetector == nullptr)
+    {
+        del_aubio_wav_source(source);
+        return false;
+    }
+
+    aubio_pitch_set_threads(pitchDetector, opts.segmentThreads);
+
+    const std::string outputPath(getOutputPath(opts, inputPath));
+    FILE* const out = std::fopen(outputPath.c_str(), opts.format == kOutputCSV ? "w" : "wb");
+
+    if (out == nullptr)
+    {
+        std::fprintf(stderr, "pitchtrack: could not open %s for writing\n", outputPath.c_str());
+        del_aubio_pitch(pitchDetector);
+        del_aubio_wav_source(source);
+        return false;
+    }
+
+    if (opts.format == kOutputCSV)
+        std::fprintf(out, "time,pitch,confidence,cv,gate\n");
+
+    fvec_t* const input = new_fvec(segmentSize);
+    fvec_t* const pitches = new_fvec(kFramesPerSegment);
+    fvec_t* const confidences = new_fvec(kFramesPerSegment);
+
+    float cvPitch = 0.f;
+    float lastKnownPitchInHz = 0.f;
+    uint64_t framePos = 0;
+    uint_t read = 0;
+    bool ok = true;
+
+    do {
+        aubio_wav_source_do(source, input, &read);
+
+        // like in the plugin, a partial frame at the end is never analysed
+        const uint32_t numFrames = read / kAubioBufferSize;
+
+        if (numFrames == 0)
+            break;
+
+        fvec_t segment;
+        segment.data = input->data;
+        segment.length = numFrames * kAubioBufferSize;
+
+        for (uint32_t i = 0; i < segment.length; ++i)
+            segment.data[i] *= opts.sensitivity;
+
+        if (aubio_pitch_do_multi(pitchDetector, &segment, kAubioBufferSize, pitches, confidences) != 0)
+        {
+            ok = false;
+            break;
+        }
+
+        for (uint32_t i = 0; i < numFrames; ++i)
+        {
+            const float detectedPitchInHz = pitches->data[i];
+            const float pitchConfidence = confidences->data[i];
+            float cvSignal;
+
+            if (detectedPitchInHz > 0.f && pitchConfidence >= opts.threshold)
+            {
+                cvPitch = pitchInHzToCV(detectedPitchInHz, opts.octave);
+                lastKnownPitchInHz = detectedPitchInHz;
+                cvSignal = 10.f;
+            }
+            else
+            {
+                if (! opts.holdOutputPitch)
+                    lastKnownPitchInHz = cvPitch = 0.0f;
+
+                cvSignal = 0.f;
+            }
+
+            // outputs change once the whole frame has been received
+            framePos += kAubioBufferSize;
+            const float time = static_cast<double>(framePos) / sampleRate;
+
+            if (opts.format == kOutputCSV)
+            {
+                std::fprintf(out, "%.6f,%.3f,%.4f,%.6f,%.0f\n",
+                             time, lastKnownPitchInHz, pitchConfidence, cvPitch, cvSignal);
+            }
+            else
+            {
+                const float row[5] = { time, lastKnownPitchInHz, pitchConfidence, cvPitch, cvSignal };
+                std::fwrite(row, sizeof(float), 5, out);
+            }
+        }
+    } while (read == segmentSize);
+
+    if (std::fclose(out) != 0)
+        ok = false;
+
+    del_fvec(confidences);
+    del_fvec(pitches);
+    del_fvec(input);
+    del_aubio_pitch(pitchDetector);
+    del_aubio_wav_source(source);
+
+    if (! ok)
+        std::fprintf(stderr, "pitchtrack: failed processing %s\n", inputPath);
+
+    return ok;
+}
+
+// -----------------------------------------------------------------------
+
+static void printUsage(const char* const name)
+{
+    std::fprintf(stderr,
+        "usage: %s [options] file.wav [file.wav ...]\n"
+        "\n"
+        "Runs WAV files through the AudioToCVPitch detector, writing one row per analysis frame\n"
+        "with time (s), pitch (Hz), confidence (0-1), CV pitch (1V/Oct) and gate (V).\n"
+        "\n"
+        "  -s value   sensitivity, in %% (default %.1f)\n"
+        "  -c value   confidence threshold, in %% (default %.2f)\n"
+        "  -t value   tolerance, in %% (default %.2f)\n"
+        "  -o value   octave shift, -4 to 4 (default %d)\n"
+        "  -H         hold last detected pitch\n"
+        "  -b         write raw 32bit float rows (native endian) instead of CSV\n"
+        "  -d dir     output directory (default is next to the input files)\n"
+        "  -j num     number of files processed in parallel (default is automatic)\n"
+        "  -J num     number of threads per file (default is automatic)\n",
+        name, kDefaultSensitivity, kDefaultThreshold, kDefaultTolerance, kDefaultOctave);
+}
+
+int main(int argc, char* argv[])
+{
+    Options opts;
+    int i = 1;
+
+    for (; i < argc && argv[i][0] == '-' && argv[i][1] != '\0'; ++i)
+    {
+        const char opt = argv[i][1];
+
+        if (opt == 'H')
+        {
+            opts.holdOutputPitch = true;
+            continue;
+        }
+        if (opt == 'b')
+        {
+            opts.format = kOutputBinary;
+            continue;
+        }
+        if (argv[i][2] != '\0' || i + 1 >= argc)
+        {
+            printUsage(argv[0]);
+            return 1;
+        }
+
+        const char* const value = argv[++i];
+
+        switch (opt)
+        {
+        case 's':
+            opts.sensitivity = std::atof(value);
+            break;
+        case 'c':
+            opts.threshold = std::atof(value) * 0.01f;
+            break;
+        case 't':
+            opts.tolerance = std::atof(value) * 0.01f;
+            break;
+        case 'o':
+            opts.octave = std::max(-4, std::min(4, std::atoi(value)));
+            break;
+        case 'd':
+            opts.outputDir = value;
+            break;
+        case 'j':
+            opts.fileThreads = std::max(0, std::atoi(value));
+            break;
+        case 'J':
+            opts.segmentThreads = std::max(0, std::atoi(value));
+            break;
+        default:
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    const int numFiles = argc - i;
+
+    if (numFiles <= 0)
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    // spread the available cores over files first, then over segments of each file
+    const uint32_t numCPUs = std::max(1u, std::thread::hardware_concurrency());
+
+    if (opts.fileThreads == 0)
+        opts.fileThreads = std::min<uint32_t>(numCPUs, numFiles);
+    if (opts.segmentThreads == 0)
+        opts.segmentThreads = std::max(1u, numCPUs / opts.fileThreads);
+
+    char** const files = argv + i;
+    std::atomic<int> nextFile(0);
+    std::atomic<int> numFailed(0);
+
+    const auto worker = [&]() {
+        for (int f; (f = nextFile++) < numFiles;)
+        {
+            if (! processFile(opts, files[f]))
+                ++numFailed;
+        }
+    };
+
+    std::vector<std::thread> threads;
+
+    for (uint32_t t = 1; t < opts.fileThreads; ++t)
+        threads.emplace_back(worker);
+
+    worker();
+
+    for (std::thread& thread : threads)
+        thread.join();
+
+    return numFailed != 0 ? 1 : 0;
+}
+
+// -----------------------------------------------------------------------